@@ -196,6 +196,9 @@ sub filter_result_string {
 
     foreach my $line (@lines) {
 
+        # Skip summaries
+        next if $line =~ m/^#/;
+
         # <thread id> <nmsecs> <ncommits> <nretries>
         $line =~ m/^(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s*$/ or die;
 
@@ -0,0 +1,141 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "histogram.h"
+#include <assert.h>
+#include <string.h>
+#include "ptr.h"
+
+static unsigned long
+bucket_of_value(unsigned long long value)
+{
+    static const unsigned long nsub = 1ul << HISTOGRAM_SUB_BITS;
+
+    if (value < nsub) {
+        return value;
+    }
+
+    unsigned long msb = 63 - __builtin_clzll(value);
+    unsigned long shift = msb - HISTOGRAM_SUB_BITS;
+
+    return ((msb - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS) +
+           ((value >> shift) & (nsub - 1));
+}
+
+/* Returns the smallest value that is sorted into the given bucket. */
+static unsigned long long
+value_of_bucket(unsigned long bucket)
+{
+    static const unsigned long nsub = 1ul << HISTOGRAM_SUB_BITS;
+
+    if (bucket < nsub) {
+        return bucket;
+    }
+
+    unsigned long exp = bucket >> HISTOGRAM_SUB_BITS;
+    unsigned long long mantissa = nsub + (bucket & (nsub - 1));
+
+    return mantissa << (exp - 1);
+}
+
+void
+histogram_init(struct histogram* self)
+{
+    assert(self);
+
+    memset(self, 0, sizeof(*self));
+}
+
+void
+histogram_add(struct histogram* self, unsigned long long value)
+{
+    assert(self);
+
+    ++self->count;
+    self->sum += value;
+    if (value > self->max) {
+        self->max = value;
+    }
+    ++self->bucket[bucket_of_value(value)];
+}
+
+void
+histogram_merge(struct histogram* self, const struct histogram* other)
+{
+    assert(self);
+    assert(other);
+
+    self->count += other->count;
+    self->sum += other->sum;
+    if (other->max > self->max) {
+        self->max = other->max;
+    }
+    for (size_t i = 0; i < arraylen(self->bucket); ++i) {
+        self->bucket[i] += other->bucket[i];
+    }
+}
+
+unsigned long long
+histogram_percentile(const struct histogram* self, double percentile)
+{
+    assert(self);
+
+    if (!self->count) {
+        return 0;
+    }
+
+    double exact_rank = self->count * percentile / 100;
+
+    unsigned long long rank = exact_rank;
+    if (rank < exact_rank) {
+        ++rank;
+    }
+    if (!rank) {
+        rank = 1;
+    }
+
+    unsigned long long n = 0;
+
+    for (size_t i = 0; i < arraylen(self->bucket); ++i) {
+        n += self->bucket[i];
+        if (n < rank) {
+            continue;
+        }
+        /* report the bucket's midpoint, but never more than the
+         * largest value we have seen */
+        unsigned long long lo = value_of_bucket(i);
+        unsigned long long hi = value_of_bucket(i + 1);
+        unsigned long long value = lo + (hi - lo) / 2;
+        return value < self->max ? value : self->max;
+    }
+
+    return self->max;
+}
+
+unsigned long long
+histogram_mean(const struct histogram* self)
+{
+    assert(self);
+
+    if (!self->count) {
+        return 0;
+    }
+    return self->sum / self->count;
+}
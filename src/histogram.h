@@ -0,0 +1,57 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#define HISTOGRAM_SUB_BITS  3
+#define HISTOGRAM_NBUCKETS  (64 << HISTOGRAM_SUB_BITS)
+
+/**
+ * A log-linear histogram of non-negative values. Each power of two
+ * is split into 2^HISTOGRAM_SUB_BITS buckets, which keeps the
+ * relative error of percentiles below 12.5%.
+ */
+struct histogram {
+    unsigned long long count;
+    unsigned long long sum;
+    unsigned long long max;
+    unsigned long long bucket[HISTOGRAM_NBUCKETS];
+};
+
+void
+histogram_init(struct histogram* self);
+
+void
+histogram_add(struct histogram* self, unsigned long long value);
+
+void
+histogram_merge(struct histogram* self, const struct histogram* other);
+
+/**
+ * Returns the approximate value at the given percentile (0 to 100).
+ */
+unsigned long long
+histogram_percentile(const struct histogram* self, double percentile);
+
+/**
+ * Returns the mean of all values, or 0 for an empty histogram.
+ */
+unsigned long long
+histogram_mean(const struct histogram* self);
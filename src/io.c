@@ -0,0 +1,261 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "io.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <picotm/picotm.h>
+#include <picotm/stdlib-tm.h>
+#include <picotm/unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "spin.h"
+#include "testhlp.h"
+#include "txstats.h"
+
+/* Number of blocks in each file */
+#define IO_NBLOCKS  1024
+
+static int*           io_fd;
+static unsigned long  io_nfds;
+static int            io_shared_fd = -1;
+static size_t         io_block_size;
+static unsigned char* io_buf;
+
+static int
+open_file(const char* dir, const char* name)
+{
+    char path[PATH_MAX];
+
+    int res = snprintf(path, sizeof(path), "%s/picotm-perf-%ld-%s.dat", dir,
+                       (long)getpid(), name);
+    if ((res < 0) || ((size_t)res >= sizeof(path))) {
+        fprintf(stderr, "path for test file too long\n");
+        return -1;
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        fprintf(stderr, "open(%s) failed: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    /* The file is only accessed through the descriptor. */
+    res = unlink(path);
+    if (res < 0) {
+        fprintf(stderr, "unlink(%s) failed: %s\n", path, strerror(errno));
+        goto err_unlink;
+    }
+
+    res = ftruncate(fd, io_block_size * IO_NBLOCKS);
+    if (res < 0) {
+        fprintf(stderr, "ftruncate() failed: %s\n", strerror(errno));
+        goto err_ftruncate;
+    }
+
+    return fd;
+
+err_ftruncate:
+err_unlink:
+    close(fd);
+    return -1;
+}
+
+int
+io_test_init(unsigned long nthreads, const struct test_params* params)
+{
+    io_block_size = params->block_size;
+
+    io_buf = malloc(nthreads * io_block_size);
+    if (nthreads && io_block_size && !io_buf) {
+        fprintf(stderr, "malloc() failed: %s\n", strerror(errno));
+        return -1;
+    }
+    if (io_buf) {
+        memset(io_buf, 0, nthreads * io_block_size);
+    }
+
+    io_fd = malloc(nthreads * sizeof(*io_fd));
+    if (nthreads && !io_fd) {
+        fprintf(stderr, "malloc() failed: %s\n", strerror(errno));
+        goto err_malloc;
+    }
+
+    for (io_nfds = 0; io_nfds < nthreads; ++io_nfds) {
+        char name[32];
+        snprintf(name, sizeof(name), "%lu", io_nfds);
+        io_fd[io_nfds] = open_file(params->dir, name);
+        if (io_fd[io_nfds] < 0) {
+            goto err_open_file;
+        }
+    }
+
+    io_shared_fd = open_file(params->dir, "shared");
+    if (io_shared_fd < 0) {
+        goto err_open_file;
+    }
+
+    return 0;
+
+err_open_file:
+    while (io_nfds) {
+        close(io_fd[--io_nfds]);
+    }
+    free(io_fd);
+err_malloc:
+    free(io_buf);
+    return -1;
+}
+
+void
+io_test_uninit(void)
+{
+    close(io_shared_fd);
+    io_shared_fd = -1;
+
+    while (io_nfds) {
+        close(io_fd[--io_nfds]);
+    }
+    free(io_fd);
+    io_fd = NULL;
+
+    free(io_buf);
+    io_buf = NULL;
+}
+
+void
+io_test_private_rw(unsigned long tid, unsigned long nloads,
+                   unsigned long nstores, unsigned long ncompute,
+                   struct tx_stats* stats)
+{
+    int fd = io_fd[tid];
+    unsigned char* buf = io_buf + tid * io_block_size;
+
+    picotm_begin
+
+        tx_stats_begin_attempt(stats);
+
+        unsigned int seed = tid;
+
+        for (unsigned long i = 0; i < nloads; ++i) {
+
+            int rngval = rand_r_tm(&seed);
+
+            off_t off = (rngval % IO_NBLOCKS) * io_block_size;
+
+            lseek_tx(fd, off, SEEK_SET);
+            read_tx(fd, buf, io_block_size);
+        }
+
+        spin_nsecs(ncompute);
+
+        for (unsigned long i = 0; i < nstores; ++i) {
+
+            int rngval = rand_r_tm(&seed);
+
+            off_t off = (rngval % IO_NBLOCKS) * io_block_size;
+
+            lseek_tx(fd, off, SEEK_SET);
+            write_tx(fd, buf, io_block_size);
+        }
+
+        tx_stats_end_exec(stats);
+
+    picotm_commit
+
+        abort_transaction_on_error(__func__);
+
+    picotm_end
+
+    tx_stats_end_commit(stats);
+}
+
+void
+io_test_shared_rw(unsigned long tid, unsigned long nloads,
+                  unsigned long nstores, unsigned long ncompute,
+                  struct tx_stats* stats)
+{
+    int fd = io_shared_fd;
+    unsigned char* buf = io_buf + tid * io_block_size;
+
+    picotm_begin
+
+        tx_stats_begin_attempt(stats);
+
+        unsigned int seed = tid;
+
+        for (unsigned long i = 0; i < nloads; ++i) {
+
+            int rngval = rand_r_tm(&seed);
+
+            off_t off = (rngval % IO_NBLOCKS) * io_block_size;
+
+            lseek_tx(fd, off, SEEK_SET);
+            read_tx(fd, buf, io_block_size);
+        }
+
+        spin_nsecs(ncompute);
+
+        for (unsigned long i = 0; i < nstores; ++i) {
+
+            int rngval = rand_r_tm(&seed);
+
+            off_t off = (rngval % IO_NBLOCKS) * io_block_size;
+
+            pwrite_tx(fd, buf, io_block_size, off);
+        }
+
+        tx_stats_end_exec(stats);
+
+    picotm_commit
+
+        abort_transaction_on_error(__func__);
+
+    picotm_end
+
+    tx_stats_end_commit(stats);
+}
+
+void
+io_model_private_rw(struct access_model* model,
+                    const struct test_params* params)
+{
+    model->pattern = ACCESS_PRIVATE;
+    model->region = NULL;
+    model->footprint = (double)IO_NBLOCKS * params->block_size;
+    model->access_size = params->block_size;
+    model->align = params->block_size;
+}
+
+void
+io_model_shared_rw(struct access_model* model,
+                   const struct test_params* params)
+{
+    /* The model only covers the file's blocks; conflicts on the shared
+     * file offset show up as excess restarts. */
+    model->pattern = ACCESS_UNIFORM;
+    model->region = &io_shared_fd;
+    model->footprint = (double)IO_NBLOCKS * params->block_size;
+    model->access_size = params->block_size;
+    model->align = params->block_size;
+}
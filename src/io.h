@@ -0,0 +1,56 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "test.h"
+
+/*
+ * Workloads with transactional file I/O. Each thread either uses its
+ * own file or all threads share a single file. Loads read a block at
+ * a random offset with lseek_tx() and read_tx(); stores write a block
+ * with lseek_tx() and write_tx() to the private file, or with
+ * pwrite_tx() to the shared file. Files are created in the test
+ * directory and unlinked right after opening.
+ */
+
+int
+io_test_init(unsigned long nthreads, const struct test_params* params);
+
+void
+io_test_uninit(void);
+
+void
+io_test_private_rw(unsigned long tid, unsigned long nloads,
+                   unsigned long nstores, unsigned long ncompute,
+                   struct tx_stats* stats);
+
+void
+io_test_shared_rw(unsigned long tid, unsigned long nloads,
+                  unsigned long nstores, unsigned long ncompute,
+                  struct tx_stats* stats);
+
+void
+io_model_private_rw(struct access_model* model,
+                    const struct test_params* params);
+
+void
+io_model_shared_rw(struct access_model* model,
+                   const struct test_params* params);
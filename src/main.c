@@ -18,8 +18,15 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "procstat.h"
+#include "spin.h"
+#include "ptr.h"
+#include "report.h"
 #include "test.h"
 #include "tm.h"
 #include "opts.h"
@@ -34,6 +41,148 @@ find_test(enum opt_io_pattern io_pattern)
     return tm_test + io_pattern;
 }
 
+static struct test_result result[OPT_MAX_GROUPS];
+
+/* Runs the test groups on the large workload with geometrically
+ * growing read and write sets, first with loads only, then with stores
+ * only. After each run, the cost per access, the split between
+ * execution and commit, and the growth of the process' memory is
+ * reported. The workload's buffer is faulted in before taking the
+ * baseline, so the growth only reflects picotm and the benchmark's
+ * bookkeeping. */
+static int
+run_sweep(struct test_group* group, size_t ngroups,
+          const struct test_params* params)
+{
+    static const unsigned long max_naccesses = 1ul << 20;
+
+    const struct test_func* test = find_test(IO_PATTERN_LARGE);
+    if (!test) {
+        return -1;
+    }
+    for (size_t i = 0; i < ngroups; ++i) {
+        group[i].test = test;
+    }
+
+    tm_test_large_prefault();
+
+    long rss_base = proc_status_kib("VmRSS");
+    if (rss_base < 0) {
+        return -1;
+    }
+
+    for (unsigned long nstores = 0; nstores < 2; ++nstores) {
+        for (unsigned long n = 1; n <= max_naccesses; n *= 4) {
+
+            for (size_t i = 0; i < ngroups; ++i) {
+                group[i].nloads = nstores ? 0 : n;
+                group[i].nstores = nstores ? n : 0;
+            }
+
+            int res = run_test(group, ngroups, params, result);
+            if (res < 0) {
+                return -1;
+            }
+
+            long rss = proc_status_kib("VmRSS");
+            long rss_peak = proc_status_kib("VmHWM");
+
+            for (size_t i = 0; i < ngroups; ++i) {
+
+                const struct test_result* res = result + i;
+                if (!res->niters) {
+                    continue;
+                }
+
+                printf("# sweep group=%zu loads=%lu stores=%lu"
+                       " nsecs_per_access=%.1f exec=%llu commit=%llu"
+                       " rss=%ld rss_growth=%ld rss_peak=%ld\n",
+                       i + 1, group[i].nloads, group[i].nstores,
+                       (double)histogram_mean(&res->latency) / n,
+                       histogram_mean(&res->exec),
+                       histogram_mean(&res->commit),
+                       rss, rss - rss_base, rss_peak);
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Runs the matrix of I/O patterns, load/store mixes and thread
+ * counts from 1 to the configured number of threads, and writes
+ * charts of the results into an HTML file. */
+static int
+run_report(const char* filename, const struct test_params* params)
+{
+    static const enum opt_io_pattern io_pattern[] = {
+        IO_PATTERN_RANDOM,
+        IO_PATTERN_SEQUENTIAL
+    };
+    static const unsigned long naccesses = 100;
+    static const unsigned long nloads_step = 10;
+
+    size_t nruns = arraylen(io_pattern) *
+                   (naccesses / nloads_step + 1) * g_nthreads;
+
+    struct report_run* run = malloc(nruns * sizeof(*run));
+    if (!run) {
+        fprintf(stderr, "malloc() failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    struct report_run* pos = run;
+
+    for (size_t i = 0; i < arraylen(io_pattern); ++i) {
+        for (unsigned long nloads = 0; nloads <= naccesses;
+                                       nloads += nloads_step) {
+            for (unsigned long nthreads = 1; nthreads <= g_nthreads;
+                                             ++nthreads, ++pos) {
+
+                struct test_group group = {
+                    .test = find_test(io_pattern[i]),
+                    .nthreads = nthreads,
+                    .nloads = nloads,
+                    .nstores = naccesses - nloads,
+                    .ncompute = g_ncompute,
+                    .nthink = g_nthink
+                };
+                if (!group.test) {
+                    goto err;
+                }
+
+                int res = run_test(&group, 1, params, result);
+                if (res < 0) {
+                    goto err;
+                }
+
+                pos->pattern = group.test->name;
+                pos->nloads = group.nloads;
+                pos->nstores = group.nstores;
+                pos->nthreads = group.nthreads;
+                pos->ncommits = result[0].ncommits;
+                pos->nrestarts = result[0].nrestarts;
+                pos->lat_p50 = histogram_percentile(&result[0].latency, 50);
+                pos->lat_p90 = histogram_percentile(&result[0].latency, 90);
+                pos->lat_p99 = histogram_percentile(&result[0].latency, 99);
+            }
+        }
+    }
+
+    int res = write_report(filename, run, nruns, params->nmsecs);
+    if (res < 0) {
+        goto err;
+    }
+
+    free(run);
+
+    return 0;
+
+err:
+    free(run);
+    return -1;
+}
+
 int
 main(int argc, char* argv[])
 {
@@ -46,12 +195,70 @@ main(int argc, char* argv[])
             break;
     }
 
-    const struct test_func* test = find_test(g_io_pattern);
-    if (!test) {
-        return EXIT_FAILURE;
+    if (g_oversubscribe) {
+        long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+        if (ncpus < 1) {
+            ncpus = 1;
+        }
+        g_nthreads = g_oversubscribe * ncpus;
+        printf("# cpus=%ld threads=%lu\n", ncpus, g_nthreads);
+    }
+
+    if (!g_ngroups) {
+        g_group[0].io_pattern = g_io_pattern;
+        g_group[0].nthreads = g_nthreads;
+        g_group[0].nloads = g_nloads;
+        g_group[0].nstores = g_nstores;
+        g_group[0].ncompute = g_ncompute;
+        g_group[0].nthink = g_nthink;
+        g_ngroups = 1;
+    }
+
+    for (size_t i = 0; i < g_ngroups; ++i) {
+        if (g_group[i].ncompute || g_group[i].nthink) {
+            if (spin_calibrate() < 0) {
+                return EXIT_FAILURE;
+            }
+            break;
+        }
     }
 
-    int res = run_test(g_nthreads, g_nmsecs, test, g_nloads, g_nstores);
+    struct test_group group[OPT_MAX_GROUPS];
+
+    for (size_t i = 0; i < g_ngroups; ++i) {
+        group[i].test = find_test(g_group[i].io_pattern);
+        if (!group[i].test) {
+            return EXIT_FAILURE;
+        }
+        group[i].nthreads = g_group[i].nthreads;
+        group[i].nloads = g_group[i].nloads;
+        group[i].nstores = g_group[i].nstores;
+        group[i].ncompute = g_group[i].ncompute;
+        group[i].nthink = g_group[i].nthink;
+    }
+
+    const struct test_params params = {
+        .nmsecs = g_nmsecs,
+        .breakdown = g_breakdown,
+        .phases = g_breakdown || g_sweep || g_trace_file,
+        .mem_interval = g_mem_interval,
+        .churn = g_churn,
+        .block_size = g_block_size,
+        .dir = g_dir,
+        .model = g_model,
+        .granularity = g_granularity,
+        .trace_file = g_trace_file,
+        .trace_nevents = g_trace_nevents
+    };
+
+    int res;
+    if (g_report) {
+        res = run_report(g_report, &params);
+    } else if (g_sweep) {
+        res = run_sweep(group, g_ngroups, &params);
+    } else {
+        res = run_test(group, g_ngroups, &params, result);
+    }
     if (res < 0) {
         return EXIT_FAILURE;
     }
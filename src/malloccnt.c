@@ -0,0 +1,179 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "malloccnt.h"
+#include <assert.h>
+#include <errno.h>
+#include <stddef.h>
+
+#if defined(ENABLE_MALLOC_COUNTER) && ENABLE_MALLOC_COUNTER
+
+/*
+ * We interpose the allocator functions for the whole process, so
+ * allocations within picotm are counted as well. The counters are
+ * thread-local to keep the hot path free of atomic operations.
+ */
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t nmemb, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void  __libc_free(void* ptr);
+extern void* __libc_memalign(size_t alignment, size_t size);
+extern void* __libc_valloc(size_t size);
+extern void* __libc_pvalloc(size_t size);
+
+static _Thread_local struct malloc_count t_count;
+
+static void
+count_alloc(size_t size)
+{
+    ++t_count.nallocs;
+    t_count.nbytes += size;
+}
+
+void*
+malloc(size_t size)
+{
+    count_alloc(size);
+    return __libc_malloc(size);
+}
+
+void*
+calloc(size_t nmemb, size_t size)
+{
+    count_alloc(nmemb * size);
+    return __libc_calloc(nmemb, size);
+}
+
+void*
+realloc(void* ptr, size_t size)
+{
+    /* Resizing counts as releasing the old block and allocating a
+     * new one; realloc(ptr, 0) only releases the block. */
+    if (ptr) {
+        ++t_count.nfrees;
+    }
+    if (!ptr || size) {
+        count_alloc(size);
+    }
+    return __libc_realloc(ptr, size);
+}
+
+void*
+reallocarray(void* ptr, size_t nmemb, size_t size)
+{
+    size_t nbytes;
+    if (__builtin_mul_overflow(nmemb, size, &nbytes)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return realloc(ptr, nbytes);
+}
+
+void*
+memalign(size_t alignment, size_t size)
+{
+    count_alloc(size);
+    return __libc_memalign(alignment, size);
+}
+
+void*
+aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int
+posix_memalign(void** memptr, size_t alignment, size_t size)
+{
+    if (!alignment || (alignment & (alignment - 1)) ||
+        (alignment % sizeof(void*))) {
+        return EINVAL;
+    }
+
+    int err = errno;
+
+    void* ptr = memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    errno = err;
+
+    *memptr = ptr;
+
+    return 0;
+}
+
+void*
+valloc(size_t size)
+{
+    count_alloc(size);
+    return __libc_valloc(size);
+}
+
+void*
+pvalloc(size_t size)
+{
+    count_alloc(size);
+    return __libc_pvalloc(size);
+}
+
+void
+free(void* ptr)
+{
+    if (ptr) {
+        ++t_count.nfrees;
+    }
+    __libc_free(ptr);
+}
+
+int
+malloc_count_is_enabled(void)
+{
+    return 1;
+}
+
+void
+malloc_count_get(struct malloc_count* count)
+{
+    assert(count);
+
+    *count = t_count;
+}
+
+#else
+
+int
+malloc_count_is_enabled(void)
+{
+    return 0;
+}
+
+void
+malloc_count_get(struct malloc_count* count)
+{
+    assert(count);
+
+    count->nallocs = 0;
+    count->nfrees = 0;
+    count->nbytes = 0;
+}
+
+#endif
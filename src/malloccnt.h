@@ -0,0 +1,38 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+/**
+ * Allocation statistics of the calling thread. The counters are only
+ * maintained if picotm-perf has been configured with
+ * --enable-malloc-counter; otherwise they remain zero.
+ */
+struct malloc_count {
+    unsigned long long nallocs;
+    unsigned long long nfrees;
+    unsigned long long nbytes;
+};
+
+int
+malloc_count_is_enabled(void);
+
+void
+malloc_count_get(struct malloc_count* count);
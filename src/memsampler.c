@@ -0,0 +1,187 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "memsampler.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "procstat.h"
+#include "testhlp.h"
+
+static int
+append_sample(struct mem_sampler* self)
+{
+    long long now = getnsecs();
+    if (now < 0) {
+        return -1;
+    }
+    long rss = proc_status_kib("VmRSS");
+    if (rss < 0) {
+        return -1;
+    }
+    long rss_peak = proc_status_kib("VmHWM");
+    if (rss_peak < 0) {
+        return -1;
+    }
+
+    size_t siz = (self->nsamples + 1) * sizeof(self->sample[0]);
+
+    struct mem_sample* sample = realloc(self->sample, siz);
+    if (!sample) {
+        fprintf(stderr, "realloc() failed: %s\n", strerror(errno));
+        return -1;
+    }
+    self->sample = sample;
+
+    sample += self->nsamples;
+    sample->msecs = (now - self->start) / 1000000;
+    sample->rss = rss;
+    sample->rss_peak = rss_peak;
+
+    ++self->nsamples;
+
+    return 0;
+}
+
+static void*
+sampler_func(void* arg)
+{
+    struct mem_sampler* self = arg;
+    assert(self);
+
+    int err = pthread_mutex_lock(&self->lock);
+    if (err) {
+        fprintf(stderr, "pthread_mutex_lock() failed: %s\n", strerror(err));
+        return NULL;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+
+    while (!self->stop) {
+
+        deadline.tv_sec += self->interval_msecs / 1000;
+        deadline.tv_nsec += (self->interval_msecs % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_nsec -= 1000000000;
+            ++deadline.tv_sec;
+        }
+
+        err = pthread_cond_timedwait(&self->cond, &self->lock, &deadline);
+        if (err && (err != ETIMEDOUT)) {
+            fprintf(stderr, "pthread_cond_timedwait() failed: %s\n",
+                    strerror(err));
+            break;
+        }
+        if (self->stop) {
+            break;
+        }
+        if (append_sample(self) < 0) {
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&self->lock);
+
+    return NULL;
+}
+
+int
+mem_sampler_start(struct mem_sampler* self, unsigned long interval_msecs)
+{
+    assert(self);
+
+    self->stop = 0;
+    self->interval_msecs = interval_msecs;
+    self->sample = NULL;
+    self->nsamples = 0;
+
+    long long start = getnsecs();
+    if (start < 0) {
+        return -1;
+    }
+    self->start = start;
+
+    int err = pthread_mutex_init(&self->lock, NULL);
+    if (err) {
+        fprintf(stderr, "pthread_mutex_init() failed: %s\n", strerror(err));
+        return -1;
+    }
+
+    err = pthread_cond_init(&self->cond, NULL);
+    if (err) {
+        fprintf(stderr, "pthread_cond_init() failed: %s\n", strerror(err));
+        goto err_pthread_cond_init;
+    }
+
+    if (!interval_msecs) {
+        /* only sample at the end */
+        return 0;
+    }
+
+    err = pthread_create(&self->thread, NULL, sampler_func, self);
+    if (err) {
+        fprintf(stderr, "pthread_create() failed: %s\n", strerror(err));
+        goto err_pthread_create;
+    }
+
+    return 0;
+
+err_pthread_create:
+    pthread_cond_destroy(&self->cond);
+err_pthread_cond_init:
+    pthread_mutex_destroy(&self->lock);
+    return -1;
+}
+
+int
+mem_sampler_stop(struct mem_sampler* self)
+{
+    assert(self);
+
+    if (self->interval_msecs) {
+
+        pthread_mutex_lock(&self->lock);
+        self->stop = 1;
+        pthread_cond_signal(&self->cond);
+        pthread_mutex_unlock(&self->lock);
+
+        int err = pthread_join(self->thread, NULL);
+        if (err) {
+            fprintf(stderr, "pthread_join() failed: %s\n", strerror(err));
+            return -1;
+        }
+    }
+
+    return append_sample(self);
+}
+
+void
+mem_sampler_uninit(struct mem_sampler* self)
+{
+    assert(self);
+
+    free(self->sample);
+    pthread_cond_destroy(&self->cond);
+    pthread_mutex_destroy(&self->lock);
+}
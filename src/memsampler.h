@@ -0,0 +1,59 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <stddef.h>
+
+struct mem_sample {
+    unsigned long long msecs;   /* time since start of sampling */
+    long rss;                   /* resident set size in KiB */
+    long rss_peak;              /* peak resident set size in KiB */
+};
+
+/**
+ * Samples the process' memory usage from a background thread at
+ * regular intervals.
+ */
+struct mem_sampler {
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    int             stop;
+
+    unsigned long      interval_msecs;
+    unsigned long long start;
+
+    struct mem_sample* sample;
+    size_t             nsamples;
+};
+
+int
+mem_sampler_start(struct mem_sampler* self, unsigned long interval_msecs);
+
+/**
+ * Stops the sampler thread and takes a final sample.
+ */
+int
+mem_sampler_stop(struct mem_sampler* self);
+
+void
+mem_sampler_uninit(struct mem_sampler* self);
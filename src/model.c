@@ -0,0 +1,216 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "model.h"
+#include <assert.h>
+#include <math.h>
+#include "test.h"
+
+/* Returns the expected number of blocks that an access of the given
+ * size covers. If accesses are aligned to the block size, the number
+ * is exact; otherwise we assume a random offset within the block. */
+static double
+blocks_per_range(double size, double align, double granularity)
+{
+    if (!fmod(align, granularity)) {
+        return ceil(size / granularity);
+    }
+    return (size - 1) / granularity + 1;
+}
+
+/* Returns the probability that two contiguous ranges of n1 and n2
+ * blocks at random positions within m blocks overlap. */
+static double
+overlap_probability(double n1, double n2, double m)
+{
+    if (!n1 || !n2) {
+        return 0;
+    }
+    double p = (n1 + n2 - 1) / m;
+    return p < 1 ? p : 1;
+}
+
+/* A transaction's loads, stores or all of its accesses, as seen by
+ * the model: n ranges of nblocks blocks each, at random positions. */
+struct access_set {
+    double n;
+    double nblocks;
+};
+
+static void
+access_set_init(struct access_set* self, const struct access_model* model,
+                unsigned long naccesses, double granularity)
+{
+    switch (model->pattern) {
+        case ACCESS_UNIFORM:
+            self->n = naccesses;
+            self->nblocks = blocks_per_range(model->access_size,
+                                             model->align, granularity);
+            return;
+        case ACCESS_SEQUENTIAL:
+            /* all accesses cover a single contiguous range */
+            self->n = !!naccesses;
+            self->nblocks = naccesses ?
+                blocks_per_range(naccesses * model->align +
+                                 model->access_size - model->align,
+                                 model->align, granularity) : 0;
+            return;
+        case ACCESS_PRIVATE:
+            break;
+    }
+    self->n = 0;
+    self->nblocks = 0;
+}
+
+/* Returns the probability that two access sets within m blocks do
+ * not overlap. We treat each pair of ranges as independent. */
+static double
+no_overlap_probability(const struct access_set* x,
+                       const struct access_set* y, double m)
+{
+    double q = overlap_probability(x->nblocks, y->nblocks, m);
+    return pow(1 - q, x->n * y->n);
+}
+
+/* Returns the probability that transactions of groups a and b do not
+ * conflict while running concurrently. Both groups' tests access the
+ * same data, but possibly with different patterns. */
+static double
+no_conflict_probability(const struct test_group* a,
+                        const struct access_model* model_a,
+                        const struct test_group* b,
+                        const struct access_model* model_b,
+                        double granularity)
+{
+    double m = ceil(model_a->footprint / granularity);
+
+    struct access_set reads_a, writes_a, writes_b, all_b;
+    access_set_init(&reads_a, model_a, a->nloads, granularity);
+    access_set_init(&writes_a, model_a, a->nstores, granularity);
+    access_set_init(&writes_b, model_b, b->nstores, granularity);
+    access_set_init(&all_b, model_b, b->nloads + b->nstores, granularity);
+
+    /* each write of one transaction against each access of the
+     * other, and each read against each write */
+    return no_overlap_probability(&writes_a, &all_b, m) *
+           no_overlap_probability(&reads_a, &writes_b, m);
+}
+
+/* Computes the probability that an attempt of a transaction in
+ * group[i] aborts, and the probability that a thread of group[i] has
+ * any conflicting access sets. If duty is non-NULL, it holds the
+ * fraction of time that each group's threads spend inside a
+ * transaction; otherwise they always are. */
+static void
+model_probabilities(const struct test_group* group, size_t ngroups,
+                    size_t i, size_t granularity, const double* duty,
+                    const struct test_params* params,
+                    double* p_abort, double* p_conflict)
+{
+    assert(granularity);
+
+    *p_abort = 0;
+    *p_conflict = 0;
+
+    if (!group[i].test->model) {
+        return;
+    }
+
+    struct access_model model_i;
+    group[i].test->model(&model_i, params);
+
+    if (model_i.pattern == ACCESS_PRIVATE) {
+        return;
+    }
+
+    double p_no_abort = 1;
+    double p_no_conflict = 1;
+
+    for (size_t j = 0; j < ngroups; ++j) {
+
+        if (!group[j].test->model) {
+            continue;
+        }
+
+        struct access_model model_j;
+        group[j].test->model(&model_j, params);
+
+        if ((model_j.pattern == ACCESS_PRIVATE) ||
+            (model_j.region != model_i.region)) {
+            /* tests on different data are independent */
+            continue;
+        }
+
+        unsigned long nothers = group[j].nthreads - (i == j);
+
+        double p = no_conflict_probability(group + i, &model_i,
+                                           group + j, &model_j,
+                                           granularity);
+        double d = duty ? duty[j] : 1;
+
+        /* a conflicting thread only aborts us while it runs a
+         * transaction */
+        p_no_abort *= pow(1 - (1 - p) * d, nothers);
+        p_no_conflict *= pow(p, nothers);
+    }
+
+    *p_abort = (1 - p_no_abort) / 2;
+    *p_conflict = 1 - p_no_conflict;
+}
+
+double
+model_abort_probability(const struct test_group* group, size_t ngroups,
+                        size_t i, size_t granularity, const double* duty,
+                        const struct test_params* params)
+{
+    double p_abort, p_conflict;
+    model_probabilities(group, ngroups, i, granularity, duty, params,
+                        &p_abort, &p_conflict);
+    return p_abort;
+}
+
+double
+model_conflict_probability(const struct test_group* group, size_t ngroups,
+                           size_t i, size_t granularity,
+                           const struct test_params* params)
+{
+    double p_abort, p_conflict;
+    model_probabilities(group, ngroups, i, granularity, NULL, params,
+                        &p_abort, &p_conflict);
+    return p_conflict;
+}
+
+double
+model_restarts_per_commit(double abort_probability,
+                          double conflict_probability)
+{
+    if (!conflict_probability) {
+        return 0;
+    }
+
+    /* Only the fraction of threads with conflicting access sets
+     * aborts; each of them on every attempt with the same
+     * probability. */
+    double p = abort_probability / conflict_probability;
+    if (p >= 1) {
+        return INFINITY;
+    }
+    return conflict_probability * p / (1 - p);
+}
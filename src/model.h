@@ -0,0 +1,66 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+struct test_group;
+struct test_params;
+
+/**
+ * Returns the probability that an attempt of a transaction in
+ * group[i] aborts, as predicted by an analytic model. The model
+ * assumes that conflicts are detected on blocks of the given
+ * granularity in bytes, and that each conflict aborts one of the two
+ * transactions. The array duty holds the fraction of time that each
+ * group's threads spend inside transactions, which is less than 1
+ * with think time. If duty is NULL, all threads are assumed to always
+ * be inside a transaction.
+ *
+ * The workloads seed their random numbers with the thread id, so each
+ * thread accesses the same addresses in every transaction. The result
+ * is the expectation over randomly placed access sets, averaged over
+ * all threads of the group.
+ */
+double
+model_abort_probability(const struct test_group* group, size_t ngroups,
+                        size_t i, size_t granularity, const double* duty,
+                        const struct test_params* params);
+
+/**
+ * Returns the probability that the access set of a thread in group[i]
+ * overlaps the access set of any other thread.
+ */
+double
+model_conflict_probability(const struct test_group* group, size_t ngroups,
+                           size_t i, size_t granularity,
+                           const struct test_params* params);
+
+/**
+ * Returns the expected number of restarts per commit for the given
+ * abort probability of a single attempt and the given conflict
+ * probability. With fixed access sets, retries are not independent.
+ * Only threads whose sets overlap other threads' sets abort, and they
+ * do so in every attempt with the same probability.
+ */
+double
+model_restarts_per_commit(double abort_probability,
+                          double conflict_probability);
@@ -31,6 +31,46 @@ unsigned long       g_nthreads = 1;
 unsigned long       g_nloads = 0;
 unsigned long       g_nstores = 0;
 unsigned long       g_nmsecs = 0;
+unsigned long       g_ncompute = 0;
+unsigned long       g_nthink = 0;
+int                 g_sweep = 0;
+const char*         g_report = NULL;
+int                 g_breakdown = 0;
+unsigned long       g_mem_interval = 0;
+unsigned long       g_churn = 0;
+unsigned long       g_oversubscribe = 0;
+unsigned long       g_block_size = 4096;
+const char*         g_dir = "/tmp";
+int                 g_model = 0;
+unsigned long       g_granularity = 8;
+const char*         g_trace_file = NULL;
+unsigned long       g_trace_nevents = 65536;
+struct opt_group    g_group[OPT_MAX_GROUPS];
+size_t              g_ngroups = 0;
+
+static const char * const io_pattern_str[] = {
+    "random",
+    "sequential",
+    "large",
+    "file",
+    "shared_file"
+};
+
+static enum parse_opts_result
+parse_io_pattern(const char* str, size_t len, enum opt_io_pattern* io_pattern)
+{
+    for (size_t i = 0; i < arraylen(io_pattern_str); ++i) {
+        if ((strlen(io_pattern_str[i]) == len) &&
+            !strncmp(io_pattern_str[i], str, len)) {
+            *io_pattern = i;
+            return PARSE_OPTS_OK;
+        }
+    }
+
+    fprintf(stderr, "unknown I/O pattern '%.*s'\n", (int)len, str);
+
+    return PARSE_OPTS_ERROR;
+}
 
 static enum parse_opts_result
 opt_nthreads(const char* optarg)
@@ -54,18 +94,7 @@ opt_nthreads(const char* optarg)
 static enum parse_opts_result
 opt_pattern(const char* optarg)
 {
-    static const char * const optstr[] = {"random", "sequential"};
-
-    for (size_t i = 0; i < arraylen(optstr); ++i) {
-        if (!strcmp(optstr[i], optarg)) {
-            g_io_pattern = i;
-            return PARSE_OPTS_OK;
-        }
-    }
-
-    fprintf(stderr, "unknown I/O pattern '%s'\n", optarg);
-
-    return PARSE_OPTS_ERROR;
+    return parse_io_pattern(optarg, strlen(optarg), &g_io_pattern);
 }
 
 static enum parse_opts_result
@@ -113,6 +142,288 @@ opt_nmsecs(const char* optarg)
     return PARSE_OPTS_OK;
 }
 
+static enum parse_opts_result
+opt_ncompute(const char* optarg)
+{
+    errno = 0;
+
+    g_ncompute = strtoul(optarg, NULL, 0);
+
+    if (errno) {
+        perror("strtoul()");
+        return PARSE_OPTS_ERROR;
+    }
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_nthink(const char* optarg)
+{
+    errno = 0;
+
+    g_nthink = strtoul(optarg, NULL, 0);
+
+    if (errno) {
+        perror("strtoul()");
+        return PARSE_OPTS_ERROR;
+    }
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_breakdown(const char* optarg)
+{
+    g_breakdown = 1;
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_churn(const char* optarg)
+{
+    errno = 0;
+
+    g_churn = strtoul(optarg, NULL, 0);
+
+    if (errno) {
+        perror("strtoul()");
+        return PARSE_OPTS_ERROR;
+    }
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_oversubscribe(const char* optarg)
+{
+    errno = 0;
+
+    g_oversubscribe = strtoul(optarg, NULL, 0);
+
+    if (errno) {
+        perror("strtoul()");
+        return PARSE_OPTS_ERROR;
+    }
+
+    if (!g_oversubscribe) {
+        fprintf(stderr, "oversubscription factor must be at least 1\n");
+        return PARSE_OPTS_ERROR;
+    }
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_block_size(const char* optarg)
+{
+    errno = 0;
+
+    g_block_size = strtoul(optarg, NULL, 0);
+
+    if (errno) {
+        perror("strtoul()");
+        return PARSE_OPTS_ERROR;
+    }
+
+    if (!g_block_size) {
+        fprintf(stderr, "block size must be at least 1 byte\n");
+        return PARSE_OPTS_ERROR;
+    }
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_dir(const char* optarg)
+{
+    g_dir = optarg;
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_model(const char* optarg)
+{
+    g_model = 1;
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_granularity(const char* optarg)
+{
+    errno = 0;
+
+    g_granularity = strtoul(optarg, NULL, 0);
+
+    if (errno) {
+        perror("strtoul()");
+        return PARSE_OPTS_ERROR;
+    }
+
+    if (!g_granularity) {
+        fprintf(stderr, "granularity must be at least 1 byte\n");
+        return PARSE_OPTS_ERROR;
+    }
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_trace_file(const char* optarg)
+{
+    g_trace_file = optarg;
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_trace_nevents(const char* optarg)
+{
+    errno = 0;
+
+    g_trace_nevents = strtoul(optarg, NULL, 0);
+
+    if (errno) {
+        perror("strtoul()");
+        return PARSE_OPTS_ERROR;
+    }
+
+    if (!g_trace_nevents) {
+        fprintf(stderr, "at least 1 trace event required\n");
+        return PARSE_OPTS_ERROR;
+    }
+
+    if (g_trace_nevents > OPT_MAX_TRACE_NEVENTS) {
+        fprintf(stderr, "at most %lu trace events supported\n",
+                OPT_MAX_TRACE_NEVENTS);
+        return PARSE_OPTS_ERROR;
+    }
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_mem_interval(const char* optarg)
+{
+    errno = 0;
+
+    g_mem_interval = strtoul(optarg, NULL, 0);
+
+    if (errno) {
+        perror("strtoul()");
+        return PARSE_OPTS_ERROR;
+    }
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_report(const char* optarg)
+{
+    g_report = optarg;
+
+    return PARSE_OPTS_OK;
+}
+
+static enum parse_opts_result
+opt_sweep(const char* optarg)
+{
+    g_sweep = 1;
+
+    return PARSE_OPTS_OK;
+}
+
+/* Parses a group of threads in the format of
+ *
+ *  <number>x<pattern>[:<param>=<number>[,<param>=<number>]...]
+ *
+ * with <param> being L for loads, S for stores, C for computation
+ * or K for think time.
+ */
+static enum parse_opts_result
+opt_group(const char* optarg)
+{
+    if (g_ngroups == arraylen(g_group)) {
+        fprintf(stderr, "at most %zu thread groups supported\n",
+                arraylen(g_group));
+        return PARSE_OPTS_ERROR;
+    }
+
+    struct opt_group* group = g_group + g_ngroups;
+    group->nloads = 0;
+    group->nstores = 0;
+    group->ncompute = 0;
+    group->nthink = 0;
+
+    errno = 0;
+
+    char* pos;
+    group->nthreads = strtoul(optarg, &pos, 0);
+
+    if (errno) {
+        perror("strtoul()");
+        return PARSE_OPTS_ERROR;
+    }
+
+    if (!group->nthreads || (*pos != 'x')) {
+        fprintf(stderr, "invalid thread group '%s'\n", optarg);
+        return PARSE_OPTS_ERROR;
+    }
+    ++pos;
+
+    size_t len = strcspn(pos, ":");
+    enum parse_opts_result res =
+        parse_io_pattern(pos, len, &group->io_pattern);
+    if (res) {
+        return res;
+    }
+    pos += len;
+
+    while (*pos) {
+
+        ++pos; /* skip ':' or ',' */
+
+        unsigned long* param;
+
+        if (!strncmp(pos, "L=", 2)) {
+            param = &group->nloads;
+        } else if (!strncmp(pos, "S=", 2)) {
+            param = &group->nstores;
+        } else if (!strncmp(pos, "C=", 2)) {
+            param = &group->ncompute;
+        } else if (!strncmp(pos, "K=", 2)) {
+            param = &group->nthink;
+        } else {
+            fprintf(stderr, "invalid parameter in thread group '%s'\n",
+                    optarg);
+            return PARSE_OPTS_ERROR;
+        }
+        pos += 2;
+
+        errno = 0;
+
+        *param = strtoul(pos, &pos, 0);
+
+        if (errno) {
+            perror("strtoul()");
+            return PARSE_OPTS_ERROR;
+        }
+
+        if (*pos && (*pos != ',')) {
+            fprintf(stderr, "invalid parameter in thread group '%s'\n",
+                    optarg);
+            return PARSE_OPTS_ERROR;
+        }
+    }
+
+    ++g_ngroups;
+
+    return PARSE_OPTS_OK;
+}
+
 static enum parse_opts_result
 opt_help(const char* optarg)
 {
@@ -122,9 +433,44 @@ opt_help(const char* optarg)
            "  -h                            This help\n"
            "  -t <number>                   Number of concurrent threads\n"
            "  -T                            Time of test in milliseconds\n"
-           "  -P <pattern>                  I/O pattern, <random|sequential>\n"
+           "  -P <pattern>                  I/O pattern, <random|sequential|large|\n"
+           "                                file|shared_file>\n"
            "  -L                            Number of loads per transaction\n"
            "  -S                            Number of stores per transaction\n"
+           "  -B                            Print time spent in execution, commit and\n"
+           "                                abort phases per thread and group\n"
+           "  -b <number>                   Block size in bytes for file I/O patterns\n"
+           "  -D <directory>                Directory for test files, default /tmp\n"
+           "  -O <number>                   Run <number> threads per online CPU;\n"
+           "                                overrides -t, not with -G\n"
+           "  -C <number>                   Replace each thread by a new one after\n"
+           "                                <number> transactions\n"
+           "  -M <number>                   Sample memory usage every <number>\n"
+           "                                milliseconds\n"
+           "  -c <number>                   Nanoseconds of computation within each\n"
+           "                                transaction, between loads and stores\n"
+           "  -k <number>                   Nanoseconds of think time between\n"
+           "                                transactions\n"
+           "  -m                            Print restarts predicted by a conflict\n"
+           "                                model next to the measured restarts\n"
+           "  -g <number>                   Lock granularity in bytes for the\n"
+           "                                conflict model, default 8\n"
+           "  -W                            Sweep read and write sets from 1 to 1M\n"
+           "                                accesses per transaction; runs the large\n"
+           "                                I/O pattern, regardless of -P\n"
+           "  -E <file>                     Trace transaction events and write them\n"
+           "                                to <file> in Chrome trace-event format\n"
+           "  -e <number>                   Number of trace events kept per thread,\n"
+           "                                default 65536, at most 16777216\n"
+           "  -R <file>                     Run random and sequential patterns with\n"
+           "                                0 to 100 loads of 100 accesses on 1 to -t\n"
+           "                                threads, and write an HTML report; not\n"
+           "                                with -G, -L, -P, -S or -W\n"
+           "  -G <n>x<pattern>[:L=<n>,S=<n>,C=<n>,K=<n>]\n"
+           "                                Add a group of <n> threads with their own\n"
+           "                                I/O pattern, loads and stores; can be given\n"
+           "                                multiple times and overrides -t, -P, -L,\n"
+           "                                -S, -c, -k\n"
            );
 
     return PARSE_OPTS_EXIT;
@@ -150,12 +496,27 @@ enum parse_opts_result
 parse_opts(int argc, char *argv[])
 {
     static enum parse_opts_result (* const opt[])(const char*) = {
+        ['B'] = opt_breakdown,
+        ['C'] = opt_churn,
+        ['D'] = opt_dir,
+        ['E'] = opt_trace_file,
+        ['G'] = opt_group,
         ['L'] = opt_nloads,
+        ['M'] = opt_mem_interval,
+        ['O'] = opt_oversubscribe,
         ['P'] = opt_pattern,
+        ['R'] = opt_report,
         ['S'] = opt_nstores,
         ['T'] = opt_nmsecs,
         ['V'] = opt_version,
+        ['W'] = opt_sweep,
+        ['b'] = opt_block_size,
+        ['c'] = opt_ncompute,
+        ['e'] = opt_trace_nevents,
+        ['g'] = opt_granularity,
         ['h'] = opt_help,
+        ['k'] = opt_nthink,
+        ['m'] = opt_model,
         ['t'] = opt_nthreads
     };
 
@@ -164,9 +525,14 @@ parse_opts(int argc, char *argv[])
         return PARSE_OPTS_EXIT;
     }
 
+    /* The report runs its own matrix of workloads. */
+    static const char report_conflicts[] = "GLPSW";
+
+    int seen[arraylen(opt)] = {0};
+
     int c;
 
-    while ((c = getopt(argc, argv, "L:P:S:T:Vht:")) != -1) {
+    while ((c = getopt(argc, argv, "BC:D:E:G:L:M:O:P:R:S:T:VWb:c:e:g:hk:mt:")) != -1) {
         if ((c == '?') || (c == ':')) {
             return PARSE_OPTS_ERROR;
         }
@@ -177,6 +543,21 @@ parse_opts(int argc, char *argv[])
         if (res) {
             return res;
         }
+        seen[c] = 1;
+    }
+
+    if (g_oversubscribe && g_ngroups) {
+        fprintf(stderr, "-O cannot be combined with thread groups\n");
+        return PARSE_OPTS_ERROR;
+    }
+
+    if (g_report) {
+        for (const char* o = report_conflicts; *o; ++o) {
+            if (seen[(unsigned char)*o]) {
+                fprintf(stderr, "-R cannot be combined with -%c\n", *o);
+                return PARSE_OPTS_ERROR;
+            }
+        }
     }
 
     return PARSE_OPTS_OK;
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <stddef.h>
+
 enum parse_opts_result {
     PARSE_OPTS_OK,
     PARSE_OPTS_EXIT,
@@ -28,14 +30,50 @@ enum parse_opts_result {
 
 enum opt_io_pattern {
     IO_PATTERN_RANDOM,
-    IO_PATTERN_SEQUENTIAL
+    IO_PATTERN_SEQUENTIAL,
+    IO_PATTERN_LARGE,
+    IO_PATTERN_FILE,
+    IO_PATTERN_SHARED_FILE
 };
 
+/**
+ * A group of threads that share the same workload. Groups are set
+ * with -G; without any group, a single group is built from -t, -P,
+ * -L and -S.
+ */
+struct opt_group {
+    enum opt_io_pattern io_pattern;
+    unsigned long       nthreads;
+    unsigned long       nloads;
+    unsigned long       nstores;
+    unsigned long       ncompute;
+    unsigned long       nthink;
+};
+
+#define OPT_MAX_GROUPS  16
+#define OPT_MAX_TRACE_NEVENTS   (1ul << 24)
+
 extern enum opt_io_pattern g_io_pattern;
 extern unsigned long       g_nthreads;
 extern unsigned long       g_nloads;
 extern unsigned long       g_nstores;
 extern unsigned long       g_nmsecs;
+extern unsigned long       g_ncompute;
+extern unsigned long       g_nthink;
+extern int                 g_sweep;
+extern const char*         g_report;
+extern int                 g_breakdown;
+extern unsigned long       g_mem_interval;
+extern unsigned long       g_churn;
+extern unsigned long       g_oversubscribe;
+extern unsigned long       g_block_size;
+extern const char*         g_dir;
+extern int                 g_model;
+extern unsigned long       g_granularity;
+extern const char*         g_trace_file;
+extern unsigned long       g_trace_nevents;
+extern struct opt_group    g_group[OPT_MAX_GROUPS];
+extern size_t              g_ngroups;
 
 enum parse_opts_result
 parse_opts(int argc, char* argv[]);
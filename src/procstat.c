@@ -0,0 +1,56 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "procstat.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+long
+proc_status_kib(const char* field)
+{
+    FILE* file = fopen("/proc/self/status", "r");
+    if (!file) {
+        fprintf(stderr, "fopen() failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    size_t len = strlen(field);
+    long kib = -1;
+    char line[256];
+
+    while (fgets(line, sizeof(line), file)) {
+        if (strncmp(line, field, len) || (line[len] != ':')) {
+            continue;
+        }
+        if (sscanf(line + len + 1, "%ld", &kib) != 1) {
+            kib = -1;
+        }
+        break;
+    }
+
+    fclose(file);
+
+    if (kib < 0) {
+        fprintf(stderr, "no field '%s' in /proc/self/status\n", field);
+    }
+
+    return kib;
+}
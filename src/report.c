@@ -0,0 +1,351 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "report.h"
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/utsname.h>
+#include <time.h>
+#include <unistd.h>
+#include "ptr.h"
+
+/* Size of a chart in pixels */
+#define CHART_WIDTH     400
+#define CHART_HEIGHT    240
+#define CHART_LEFT      64
+#define CHART_RIGHT     16
+#define CHART_TOP       32
+#define CHART_BOTTOM    40
+
+#define MAX_SERIES  3
+
+enum chart_style {
+    CHART_BARS,
+    CHART_LINES
+};
+
+struct chart_series {
+    const char* name;
+    const char* color;
+    double*     value;
+};
+
+static void
+write_escaped(FILE* file, const char* str)
+{
+    for (; *str; ++str) {
+        switch (*str) {
+            case '<':
+                fputs("&lt;", file);
+                break;
+            case '>':
+                fputs("&gt;", file);
+                break;
+            case '&':
+                fputs("&amp;", file);
+                break;
+            default:
+                fputc(*str, file);
+                break;
+        }
+    }
+}
+
+/* Rounds up to 1, 2 or 5 times a power of ten. */
+static double
+nice_ceil(double value)
+{
+    if (value <= 0) {
+        return 1;
+    }
+    double base = pow(10, floor(log10(value)));
+    if (value <= base) {
+        return base;
+    } else if (value <= 2 * base) {
+        return 2 * base;
+    } else if (value <= 5 * base) {
+        return 5 * base;
+    }
+    return 10 * base;
+}
+
+static void
+write_chart(FILE* file, const char* title, enum chart_style style,
+            const unsigned long* x, size_t nx,
+            const struct chart_series* series, size_t nseries)
+{
+    static const int plot_width = CHART_WIDTH - CHART_LEFT - CHART_RIGHT;
+    static const int plot_height = CHART_HEIGHT - CHART_TOP - CHART_BOTTOM;
+
+    double ymax = 0;
+    for (size_t i = 0; i < nseries; ++i) {
+        for (size_t j = 0; j < nx; ++j) {
+            if (series[i].value[j] > ymax) {
+                ymax = series[i].value[j];
+            }
+        }
+    }
+    ymax = nice_ceil(ymax);
+
+    double xstep = (double)plot_width / nx;
+
+    fprintf(file, "<svg xmlns=\"http://www.w3.org/2000/svg\""
+                  " width=\"%d\" height=\"%d\" viewBox=\"0 0 %d %d\">\n",
+            CHART_WIDTH, CHART_HEIGHT, CHART_WIDTH, CHART_HEIGHT);
+    fprintf(file, "<text x=\"%d\" y=\"18\" class=\"title\">%s</text>\n",
+            CHART_LEFT, title);
+
+    /* y axis with grid lines */
+    for (int i = 0; i <= 4; ++i) {
+        double y = CHART_TOP + plot_height - plot_height * i / 4.0;
+        fprintf(file, "<line x1=\"%d\" y1=\"%.1f\" x2=\"%d\" y2=\"%.1f\""
+                      " class=\"grid\"/>\n",
+                CHART_LEFT, y, CHART_LEFT + plot_width, y);
+        fprintf(file, "<text x=\"%d\" y=\"%.1f\" class=\"ytic\">%.4g</text>\n",
+                CHART_LEFT - 4, y + 4, ymax * i / 4);
+    }
+
+    /* x axis */
+    for (size_t j = 0; j < nx; ++j) {
+        fprintf(file, "<text x=\"%.1f\" y=\"%d\" class=\"xtic\">%lu</text>\n",
+                CHART_LEFT + xstep * (j + 0.5),
+                CHART_TOP + plot_height + 16, x[j]);
+    }
+    fprintf(file, "<text x=\"%d\" y=\"%d\" class=\"xlabel\">"
+                  "Number of concurrent threads</text>\n",
+            CHART_LEFT + plot_width / 2, CHART_HEIGHT - 6);
+
+    /* data */
+    for (size_t i = 0; i < nseries; ++i) {
+        const struct chart_series* s = series + i;
+        if (style == CHART_BARS) {
+            double width = xstep * 0.8 / nseries;
+            for (size_t j = 0; j < nx; ++j) {
+                double h = plot_height * s->value[j] / ymax;
+                fprintf(file, "<rect x=\"%.1f\" y=\"%.1f\" width=\"%.1f\""
+                              " height=\"%.1f\" fill=\"%s\">"
+                              "<title>%s: %.0f</title></rect>\n",
+                        CHART_LEFT + xstep * (j + 0.1) + width * i,
+                        CHART_TOP + plot_height - h, width, h, s->color,
+                        s->name, s->value[j]);
+            }
+        } else {
+            fprintf(file, "<polyline fill=\"none\" stroke=\"%s\""
+                          " stroke-width=\"2\" points=\"", s->color);
+            for (size_t j = 0; j < nx; ++j) {
+                fprintf(file, "%.1f,%.1f ", CHART_LEFT + xstep * (j + 0.5),
+                        CHART_TOP + plot_height -
+                            plot_height * s->value[j] / ymax);
+            }
+            fprintf(file, "\"/>\n");
+        }
+        fprintf(file, "<rect x=\"%.1f\" y=\"%d\" width=\"10\" height=\"10\""
+                      " fill=\"%s\"/>\n",
+                CHART_LEFT + plot_width - 70.0 * (nseries - i), 8, s->color);
+        fprintf(file, "<text x=\"%.1f\" y=\"17\" class=\"legend\">%s</text>\n",
+                CHART_LEFT + plot_width - 70.0 * (nseries - i) + 14,
+                s->name);
+    }
+
+    fprintf(file, "</svg>\n");
+}
+
+static void
+write_system_info(FILE* file)
+{
+    fprintf(file, "<h2>System Information</h2>\n<table>\n");
+
+    char model[256] = "Unknown processor";
+    FILE* cpuinfo = fopen("/proc/cpuinfo", "r");
+    if (cpuinfo) {
+        char line[256];
+        while (fgets(line, sizeof(line), cpuinfo)) {
+            if (strncmp(line, "model name", 10)) {
+                continue;
+            }
+            const char* value = strchr(line, ':');
+            if (value) {
+                snprintf(model, sizeof(model), "%s", value + 2);
+                model[strcspn(model, "\n")] = '\0';
+            }
+            break;
+        }
+        fclose(cpuinfo);
+    }
+    fprintf(file, "<tr><td>Processor</td><td>");
+    write_escaped(file, model);
+    fprintf(file, "</td></tr>\n");
+
+    fprintf(file, "<tr><td>Number of processors</td><td>%ld</td></tr>\n",
+            sysconf(_SC_NPROCESSORS_ONLN));
+
+    struct utsname uts;
+    if (!uname(&uts)) {
+        fprintf(file, "<tr><td>Kernel</td><td>");
+        write_escaped(file, uts.sysname);
+        fputc(' ', file);
+        write_escaped(file, uts.release);
+        fputc(' ', file);
+        write_escaped(file, uts.version);
+        fprintf(file, "</td></tr>\n");
+    }
+
+    fprintf(file, "</table>\n");
+}
+
+static int
+is_same_chart(const struct report_run* lhs, const struct report_run* rhs)
+{
+    return !strcmp(lhs->pattern, rhs->pattern) &&
+           (lhs->nloads == rhs->nloads) &&
+           (lhs->nstores == rhs->nstores);
+}
+
+/* Writes the charts for the runs in [beg, end), one data point
+ * per run. */
+static int
+write_charts(FILE* file, const struct report_run* beg,
+             const struct report_run* end)
+{
+    size_t nx = end - beg;
+
+    unsigned long* x = malloc(nx * sizeof(*x));
+    if (!x) {
+        fprintf(stderr, "malloc() failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    double* value = malloc(nx * (2 + MAX_SERIES) * sizeof(*value));
+    if (!value) {
+        fprintf(stderr, "malloc() failed: %s\n", strerror(errno));
+        goto err_malloc_value;
+    }
+
+    struct chart_series commits = {"commits/s", "#3366cc", value};
+    struct chart_series restarts = {"restarts/s", "#cc3333", value + nx};
+    struct chart_series latency[MAX_SERIES] = {
+        {"p50", "#33aa33", value + 2 * nx},
+        {"p90", "#dd9900", value + 3 * nx},
+        {"p99", "#cc3333", value + 4 * nx}
+    };
+
+    for (size_t i = 0; i < nx; ++i) {
+        const struct report_run* run = beg + i;
+        x[i] = run->nthreads;
+        commits.value[i] = run->ncommits;
+        restarts.value[i] = run->nrestarts;
+        latency[0].value[i] = run->lat_p50 / 1000.0;
+        latency[1].value[i] = run->lat_p90 / 1000.0;
+        latency[2].value[i] = run->lat_p99 / 1000.0;
+    }
+
+    fprintf(file, "<h3>I/O pattern <em>%s</em>, %lu loads, %lu stores</h3>\n"
+                  "<div class=\"row\">\n",
+            beg->pattern, beg->nloads, beg->nstores);
+    write_chart(file, "Commits per second", CHART_BARS, x, nx, &commits, 1);
+    write_chart(file, "Restarts per second", CHART_BARS, x, nx, &restarts, 1);
+    write_chart(file, "Latency in \xc2\xb5s", CHART_LINES, x, nx, latency,
+                arraylen(latency));
+    fprintf(file, "</div>\n");
+
+    free(value);
+    free(x);
+
+    return 0;
+
+err_malloc_value:
+    free(x);
+    return -1;
+}
+
+int
+write_report(const char* filename, const struct report_run* run,
+             size_t nruns, unsigned long nmsecs)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "fopen(%s) failed: %s\n", filename, strerror(errno));
+        return -1;
+    }
+
+    time_t now = time(NULL);
+    char date[64];
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S UTC", gmtime(&now));
+
+    fprintf(file,
+            "<!DOCTYPE html>\n"
+            "<html>\n<head>\n<meta charset=\"utf-8\">\n"
+            "<title>picotm Performance Tests</title>\n"
+            "<style>\n"
+            "body { font-family: sans-serif; margin: 2em; }\n"
+            "td { padding-right: 2em; }\n"
+            ".row { display: flex; flex-wrap: wrap; gap: 1em; }\n"
+            "svg { border: 1px solid #ccc; }\n"
+            "svg text { font-size: 11px; }\n"
+            ".title { font-weight: bold; font-size: 13px; }\n"
+            ".grid { stroke: #e0e0e0; }\n"
+            ".ytic { text-anchor: end; }\n"
+            ".xtic, .xlabel { text-anchor: middle; }\n"
+            "</style>\n"
+            "</head>\n<body>\n"
+            "<h1>picotm Performance Tests</h1>\n"
+            "<p>Generated by picotm-perf on %s; %lu ms per run.</p>\n",
+            date, nmsecs);
+
+    write_system_info(file);
+
+    const char* pattern = NULL;
+
+    for (const struct report_run* beg = run, *end = run + nruns; beg < end;) {
+
+        const struct report_run* pos = beg;
+        while ((pos < end) && is_same_chart(beg, pos)) {
+            ++pos;
+        }
+
+        if (!pattern || strcmp(pattern, beg->pattern)) {
+            pattern = beg->pattern;
+            fprintf(file, "<h2>I/O pattern <em>%s</em></h2>\n", pattern);
+        }
+
+        int res = write_charts(file, beg, pos);
+        if (res < 0) {
+            goto err_write_charts;
+        }
+
+        beg = pos;
+    }
+
+    fprintf(file, "</body>\n</html>\n");
+
+    if (fclose(file) == EOF) {
+        fprintf(stderr, "fclose(%s) failed: %s\n", filename, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+
+err_write_charts:
+    fclose(file);
+    return -1;
+}
@@ -0,0 +1,49 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * The results of a single run within a report.
+ */
+struct report_run {
+    const char*   pattern;
+    unsigned long nloads;
+    unsigned long nstores;
+    unsigned long nthreads;
+
+    double ncommits;    /* commits per second */
+    double nrestarts;   /* restarts per second */
+
+    unsigned long long lat_p50; /* latencies in nanoseconds */
+    unsigned long long lat_p90;
+    unsigned long long lat_p99;
+};
+
+/**
+ * Writes a self-contained HTML file with charts of the given runs.
+ * Runs with the same pattern, loads and stores form one set of charts
+ * over the number of threads; runs must be sorted accordingly.
+ */
+int
+write_report(const char* filename, const struct report_run* run,
+             size_t nruns, unsigned long nmsecs);
@@ -0,0 +1,69 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "spin.h"
+#include "testhlp.h"
+
+/* spin-loop iterations per microsecond */
+static unsigned long long spin_iters_per_usec = 1000;
+
+static void
+spin(unsigned long long iters)
+{
+    for (volatile unsigned long long i = 0; i < iters; ++i) { }
+}
+
+int
+spin_calibrate(void)
+{
+    static const unsigned long long iters = 1000000;
+
+    unsigned long long min_nsecs = 0;
+
+    /* take the fastest of a few runs to filter out preemption */
+    for (int i = 0; i < 5; ++i) {
+        long long beg = getnsecs();
+        if (beg < 0) {
+            return -1;
+        }
+        spin(iters);
+        long long end = getnsecs();
+        if (end < 0) {
+            return -1;
+        }
+        unsigned long long nsecs = end - beg;
+        if (!min_nsecs || (nsecs < min_nsecs)) {
+            min_nsecs = nsecs;
+        }
+    }
+
+    if (!min_nsecs) {
+        min_nsecs = 1;
+    }
+    spin_iters_per_usec = iters * 1000 / min_nsecs;
+
+    return 0;
+}
+
+void
+spin_nsecs(unsigned long nsecs)
+{
+    spin(nsecs * spin_iters_per_usec / 1000);
+}
@@ -26,61 +26,85 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/time.h>
-
-/* Returns the number of milliseconds since the epoch */
-static long long
-getmsofday(void* tzp)
-{
-    struct timeval t;
-    int res = gettimeofday(&t, tzp);
-    if (res < 0) {
-        fprintf(stderr, "gettimeofday() failed: %s\n",
-                strerror(res));
-        return -1;
-    }
-
-    return t.tv_sec * 1000 + t.tv_usec / 1000;
-}
+#include "histogram.h"
+#include "memsampler.h"
+#include "model.h"
+#include "spin.h"
+#include "testhlp.h"
+#include "trace.h"
+#include "txstats.h"
 
 struct thread {
 
     pthread_t          thread;
     pthread_barrier_t* wait;
     unsigned long      nmsecs;
+    unsigned long      churn;
 
     unsigned long long  res_niters;
     unsigned long long  res_nmsecs;
     unsigned long long  res_nrestarts;
-
-    call_func   call;
+    struct histogram    res_latency;
+    struct tx_stats     res_stats;
+    struct malloc_count res_malloc;
+    struct trace_ring   res_trace;
+
+    /* thread churn, with times in nanoseconds */
+    unsigned long long  res_nspawns;
+    unsigned long long  res_start_nsecs;
+    unsigned long long  res_first_nsecs;
+    unsigned long long  res_release_nsecs;
+    unsigned long long  res_teardown_nsecs;
+
+    const struct test_group* group;
     unsigned long tid;
-    unsigned long nloads;
-    unsigned long nstores;
 };
 
-static void
+static int
 thread_init(struct thread* self, pthread_barrier_t* wait, unsigned long nmsecs,
-            call_func call, unsigned long tid, unsigned long nloads,
-            unsigned long nstores)
+            unsigned long churn, int phases, size_t trace_nevents,
+            const struct test_group* group, unsigned long tid)
 {
     assert(self);
+    assert(group);
 
     self->wait = wait;
     self->nmsecs = nmsecs;
+    self->churn = churn;
     self->res_niters = 0;
     self->res_nmsecs = 0;
     self->res_nrestarts = 0;
-    self->call = call;
+    histogram_init(&self->res_latency);
+    tx_stats_init(&self->res_stats);
+    self->res_stats.enabled = phases;
+    self->res_malloc.nallocs = 0;
+    self->res_malloc.nfrees = 0;
+    self->res_malloc.nbytes = 0;
+    self->res_nspawns = 0;
+    self->res_start_nsecs = 0;
+    self->res_first_nsecs = 0;
+    self->res_release_nsecs = 0;
+    self->res_teardown_nsecs = 0;
+    self->group = group;
     self->tid = tid;
-    self->nloads = nloads;
-    self->nstores = nstores;
+
+    int res = trace_ring_init(&self->res_trace, trace_nevents);
+    if (res < 0) {
+        return -1;
+    }
+    if (trace_nevents) {
+        self->res_stats.trace = &self->res_trace;
+    }
+
+    return 0;
 }
 
 static void
 thread_uninit(struct thread* self)
 {
     assert(self);
+
+    trace_ring_uninit(&self->res_trace);
 }
 
 static void
@@ -89,14 +113,175 @@ cleanup_picotm_cb(void* data)
     picotm_release();
 }
 
+/* Runs transactions until the deadline has passed or, if non-zero,
+ * max_iters transactions have been committed. The current time is
+ * updated in place. Returns the latency of the first transaction. */
+static long long
+run_transactions(struct thread* self, unsigned long long* current_time,
+                 unsigned long long deadline, unsigned long long max_iters)
+{
+    const struct test_group* group = self->group;
+    call_func call = group->test->call;
+
+    unsigned long long iters = 0;
+    unsigned long long nrestarts = 0;
+    unsigned long long first_nsecs = 0;
+
+    struct malloc_count malloc_start;
+    malloc_count_get(&malloc_start);
+
+    while ((*current_time < deadline) && (!max_iters || iters < max_iters)) {
+
+        call(self->tid, group->nloads, group->nstores, group->ncompute,
+             &self->res_stats);
+
+        long long res = getnsecs();
+        if (res < 0) {
+            return -1;
+        }
+        if (!iters) {
+            first_nsecs = res - *current_time;
+        }
+        histogram_add(&self->res_latency, res - *current_time);
+        *current_time = res;
+        ++iters;
+        nrestarts += picotm_number_of_restarts();
+
+        if (group->nthink) {
+            spin_nsecs(group->nthink);
+            res = getnsecs();
+            if (res < 0) {
+                return -1;
+            }
+            *current_time = res;
+        }
+    }
+
+    self->res_niters += iters;
+    self->res_nrestarts += nrestarts;
+
+    struct malloc_count malloc_end;
+    malloc_count_get(&malloc_end);
+    self->res_malloc.nallocs += malloc_end.nallocs - malloc_start.nallocs;
+    self->res_malloc.nfrees += malloc_end.nfrees - malloc_start.nfrees;
+    self->res_malloc.nbytes += malloc_end.nbytes - malloc_start.nbytes;
+
+    return first_nsecs;
+}
+
+/*
+ * Thread churn
+ *
+ * With churn enabled, each thread spawns a sequence of short-lived
+ * worker threads. Each worker runs a bounded number of transactions
+ * and exits. The thread then replaces it with a new worker.
+ */
+
+struct worker {
+    struct thread*     thread;
+    unsigned long long deadline;
+
+    unsigned long long create_time;
+    unsigned long long start_time;
+    unsigned long long exit_time;
+    unsigned long long end_time;
+    long long          first_nsecs;
+    unsigned long long niters;
+    unsigned long long release_nsecs;
+};
+
 static void*
-thread_func(void* arg)
+worker_func(void* arg)
 {
-    struct thread* self = arg;
+    struct worker* self = arg;
     assert(self);
 
+    long long res = getnsecs();
+    if (res < 0) {
+        return NULL;
+    }
+    self->start_time = res;
+
+    unsigned long long current_time = res;
+
+    unsigned long long niters = self->thread->res_niters;
+
     pthread_cleanup_push(cleanup_picotm_cb, NULL);
 
+    self->first_nsecs = run_transactions(self->thread, &current_time,
+                                         self->deadline,
+                                         self->thread->churn);
+    self->end_time = current_time;
+    self->niters = self->thread->res_niters - niters;
+
+    pthread_cleanup_pop(1);
+
+    res = getnsecs();
+    if (res < 0) {
+        return NULL;
+    }
+    self->exit_time = res;
+    self->release_nsecs = self->exit_time - self->end_time;
+
+    return NULL;
+}
+
+static int
+run_workers(struct thread* self, unsigned long long* current_time,
+            unsigned long long deadline)
+{
+    while (*current_time < deadline) {
+
+        struct worker worker = {
+            .thread = self,
+            .deadline = deadline,
+            .create_time = *current_time,
+            .first_nsecs = -1
+        };
+
+        pthread_t thread;
+        int err = pthread_create(&thread, NULL, worker_func, &worker);
+        if (err) {
+            fprintf(stderr, "pthread_create() failed: %s\n", strerror(err));
+            return -1;
+        }
+
+        err = pthread_join(thread, NULL);
+        if (err) {
+            fprintf(stderr, "pthread_join() failed: %s\n", strerror(err));
+            return -1;
+        }
+
+        long long res = getnsecs();
+        if (res < 0) {
+            return -1;
+        }
+        *current_time = res;
+
+        if (worker.first_nsecs < 0) {
+            return -1;
+        }
+        if (!worker.niters) {
+            /* The worker started after the deadline. */
+            continue;
+        }
+
+        ++self->res_nspawns;
+        self->res_start_nsecs += worker.start_time - worker.create_time;
+        self->res_first_nsecs += worker.first_nsecs;
+        self->res_release_nsecs += worker.release_nsecs;
+        self->res_teardown_nsecs += *current_time - worker.exit_time;
+    }
+
+    return 0;
+}
+
+static void*
+thread_func(void* arg)
+{
+    struct thread* self = arg;
+    assert(self);
+
     if (self->wait) {
         int res = pthread_barrier_wait(self->wait);
         if (res && (res != PTHREAD_BARRIER_SERIAL_THREAD)) {
@@ -106,39 +291,26 @@ thread_func(void* arg)
         }
     }
 
-    self->res_niters = 0;
-    self->res_nmsecs = 0;
-    self->res_nrestarts = 0;
-
-    unsigned long long iters = 0;
-
-    long long res = getmsofday(NULL);
+    long long res = getnsecs();
     if (res < 0) {
         return NULL;
     }
     unsigned long long start_time = res;
     unsigned long long current_time = start_time;
-
-    unsigned long long nrestarts = 0;
-
-    while ((current_time - start_time) < self->nmsecs) {
-
-        self->call(self->tid, self->nloads, self->nstores);
-
-        long long res = getmsofday(NULL);
-        if (res < 0) {
-            return NULL;
-        }
-        current_time = res;
-        ++iters;
-        nrestarts += picotm_number_of_restarts();
+    unsigned long long deadline = start_time + self->nmsecs * 1000000ull;
+
+    if (self->churn) {
+        res = run_workers(self, &current_time, deadline);
+    } else {
+        pthread_cleanup_push(cleanup_picotm_cb, NULL);
+        res = run_transactions(self, &current_time, deadline, 0);
+        pthread_cleanup_pop(1);
+    }
+    if (res < 0) {
+        return NULL;
     }
 
-    self->res_niters = iters;
-    self->res_nmsecs = current_time - start_time;
-    self->res_nrestarts = nrestarts;
-
-    pthread_cleanup_pop(1);
+    self->res_nmsecs = (current_time - start_time) / 1000000;
 
     return NULL;
 }
@@ -179,8 +351,9 @@ thread_cancel(struct thread* self)
 
 static struct thread*
 new_threads(pthread_barrier_t* wait, unsigned long nthreads,
-            unsigned long nmsecs, call_func call, unsigned long nloads,
-            unsigned long nstores)
+            unsigned long nmsecs, unsigned long churn, int phases,
+            size_t trace_nevents, const struct test_group* group,
+            size_t ngroups)
 {
     size_t siz = sizeof(struct thread) * nthreads;
 
@@ -190,11 +363,26 @@ new_threads(pthread_barrier_t* wait, unsigned long nthreads,
         return NULL;
     }
 
-    for (unsigned int i = 0; i < nthreads; ++i) {
-        thread_init(th + i, wait, nmsecs, call, i, nloads, nstores);
+    unsigned long tid = 0;
+
+    for (size_t i = 0; i < ngroups; ++i) {
+        for (unsigned long j = 0; j < group[i].nthreads; ++j, ++tid) {
+            int res = thread_init(th + tid, wait, nmsecs, churn, phases,
+                                  trace_nevents, group + i, tid);
+            if (res < 0) {
+                goto err_thread_init;
+            }
+        }
     }
 
     return th;
+
+err_thread_init:
+    while (tid) {
+        thread_uninit(th + --tid);
+    }
+    free(th);
+    return NULL;
 }
 
 static void
@@ -271,25 +459,422 @@ print_results(const struct thread* beg, const struct thread* end)
     }
 }
 
+static void
+collect_group_results(const struct thread* beg, const struct thread* end,
+                      const struct test_group* group, size_t ngroups,
+                      struct test_result* result)
+{
+    for (size_t i = 0; i < ngroups; ++i) {
+
+        struct test_result* res = result + i;
+
+        res->ncommits = 0;
+        res->nrestarts = 0;
+        res->niters = 0;
+        histogram_init(&res->latency);
+        histogram_init(&res->exec);
+        histogram_init(&res->commit);
+        histogram_init(&res->abort);
+        res->malloc.nallocs = 0;
+        res->malloc.nfrees = 0;
+        res->malloc.nbytes = 0;
+        res->nspawns = 0;
+        res->start_nsecs = 0;
+        res->first_nsecs = 0;
+        res->release_nsecs = 0;
+        res->teardown_nsecs = 0;
+
+        for (const struct thread* pos = beg; pos < end; ++pos) {
+            if (pos->group != group + i) {
+                continue;
+            }
+            if (pos->res_nmsecs) {
+                res->ncommits += pos->res_niters * 1000.0 / pos->res_nmsecs;
+                res->nrestarts +=
+                    pos->res_nrestarts * 1000.0 / pos->res_nmsecs;
+            }
+            res->niters += pos->res_niters;
+            histogram_merge(&res->latency, &pos->res_latency);
+            histogram_merge(&res->exec, &pos->res_stats.exec);
+            histogram_merge(&res->commit, &pos->res_stats.commit);
+            histogram_merge(&res->abort, &pos->res_stats.abort);
+            res->malloc.nallocs += pos->res_malloc.nallocs;
+            res->malloc.nfrees += pos->res_malloc.nfrees;
+            res->malloc.nbytes += pos->res_malloc.nbytes;
+            res->nspawns += pos->res_nspawns;
+            res->start_nsecs += pos->res_start_nsecs;
+            res->first_nsecs += pos->res_first_nsecs;
+            res->release_nsecs += pos->res_release_nsecs;
+            res->teardown_nsecs += pos->res_teardown_nsecs;
+        }
+    }
+}
+
+/* Prints one summary line per thread group. Summaries start with
+ * '#' so that scripts which parse the per-thread results can skip
+ * them. Commits and restarts are per second, times are in
+ * nanoseconds per transaction. Phase times are only printed if they
+ * have been recorded. */
+static void
+print_group_results(const struct test_group* group, size_t ngroups,
+                    const struct test_result* result,
+                    const struct test_params* params)
+{
+    for (size_t i = 0; i < ngroups; ++i) {
+
+        const struct test_result* res = result + i;
+
+        printf("# group %zu %s threads=%lu loads=%lu stores=%lu"
+               " compute=%lu think=%lu commits=%.0f restarts=%.0f"
+               " lat_p50=%llu lat_p90=%llu lat_p99=%llu lat_max=%llu",
+               i + 1, group[i].test->name, group[i].nthreads,
+               group[i].nloads, group[i].nstores,
+               group[i].ncompute, group[i].nthink,
+               res->ncommits, res->nrestarts,
+               histogram_percentile(&res->latency, 50),
+               histogram_percentile(&res->latency, 90),
+               histogram_percentile(&res->latency, 99),
+               res->latency.max);
+
+        if (params->phases) {
+            printf(" exec=%llu commit=%llu abort=%llu",
+                   histogram_mean(&res->exec),
+                   histogram_mean(&res->commit),
+                   histogram_mean(&res->abort));
+        }
+
+        printf("\n");
+    }
+}
+
+/* Prints the process' memory usage as sampled during the test. The
+ * final sample is taken after all threads have finished. */
+static void
+print_mem_samples(const struct mem_sampler* sampler)
+{
+    for (size_t i = 0; i < sampler->nsamples; ++i) {
+        const struct mem_sample* sample = sampler->sample + i;
+        printf("# memory msecs=%llu rss=%ld rss_peak=%ld\n",
+               sample->msecs, sample->rss, sample->rss_peak);
+    }
+}
+
+static void
+print_malloc_results(size_t ngroups, const struct test_result* result)
+{
+    for (size_t i = 0; i < ngroups; ++i) {
+
+        const struct malloc_count* count = &result[i].malloc;
+
+        double nallocs_per_commit = 0;
+        if (result[i].niters) {
+            nallocs_per_commit = (double)count->nallocs / result[i].niters;
+        }
+
+        printf("# malloc group=%zu allocs=%llu frees=%llu bytes=%llu"
+               " allocs_per_commit=%.2f\n",
+               i + 1, count->nallocs, count->nfrees, count->nbytes,
+               nallocs_per_commit);
+    }
+}
+
+/* Prints the throughput of block-I/O tests. Commits and restarts are
+ * per second, mbytes_per_sec is in MB/s. */
+static void
+print_io_results(const struct test_group* group, size_t ngroups,
+                 const struct test_result* result,
+                 const struct test_params* params)
+{
+    for (size_t i = 0; i < ngroups; ++i) {
+
+        if (!group[i].test->block_io) {
+            continue;
+        }
+
+        double naccesses = group[i].nloads + group[i].nstores;
+        double nbytes = result[i].ncommits * naccesses * params->block_size;
+
+        printf("# io group=%zu block_size=%zu commits=%.0f restarts=%.0f"
+               " mbytes_per_sec=%.2f\n",
+               i + 1, params->block_size, result[i].ncommits,
+               result[i].nrestarts, nbytes / 1000000);
+    }
+}
+
+/* Prints the restarts per commit that the conflict model predicts
+ * next to the measured ones. The exact prediction only counts
+ * overlapping bytes; the excess of the measured value over the
+ * prediction at the configured lock granularity hints at conflicts
+ * the model does not cover, such as false sharing of picotm's locks
+ * or metadata. */
+static int
+print_model_results(const struct test_group* group, size_t ngroups,
+                    const struct test_result* result,
+                    const struct test_params* params)
+{
+    /* With think time, threads spend only part of their time inside
+     * transactions. */
+    double* duty = malloc(ngroups * sizeof(*duty));
+    if (!duty) {
+        fprintf(stderr, "malloc() failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    for (size_t i = 0; i < ngroups; ++i) {
+        double tx = histogram_mean(&result[i].latency);
+        double think = group[i].nthink;
+        duty[i] = (tx || think) ? tx / (tx + think) : 1;
+    }
+
+    for (size_t i = 0; i < ngroups; ++i) {
+
+        double p_exact = model_abort_probability(group, ngroups, i, 1,
+                                                 duty, params);
+        double p = model_abort_probability(group, ngroups, i,
+                                           params->granularity, duty,
+                                           params);
+
+        double exact = model_restarts_per_commit(
+            p_exact, model_conflict_probability(group, ngroups, i, 1,
+                                                params));
+        double predicted = model_restarts_per_commit(
+            p, model_conflict_probability(group, ngroups, i,
+                                          params->granularity, params));
+
+        double measured = 0;
+        if (result[i].ncommits) {
+            measured = result[i].nrestarts / result[i].ncommits;
+        }
+
+        printf("# model group=%zu granularity=%zu"
+               " p_abort_exact=%.4f p_abort=%.4f"
+               " restarts_per_commit_exact=%.4f"
+               " restarts_per_commit_predicted=%.4f"
+               " restarts_per_commit_measured=%.4f"
+               " false_conflicts=%.4f excess=%.4f%s\n",
+               i + 1, params->granularity, p_exact, p,
+               exact, predicted, measured, predicted - exact,
+               measured - predicted,
+               (measured > 2 * predicted + 0.01) ? " BEYOND-MODEL" : "");
+    }
+
+    free(duty);
+
+    return 0;
+}
+
+/* Prints the mean costs of short-lived threads in nanoseconds. The
+ * init overhead is the difference between a worker's first transaction
+ * and the mean of all following transactions. Only workers that ran
+ * at least one transaction are counted. */
+static void
+print_churn_results(size_t ngroups, const struct test_result* result)
+{
+    for (size_t i = 0; i < ngroups; ++i) {
+
+        const struct test_result* res = result + i;
+        if (!res->nspawns) {
+            continue;
+        }
+
+        unsigned long long first = res->first_nsecs / res->nspawns;
+
+        printf("# churn group=%zu spawns=%llu start=%llu first_tx=%llu",
+               i + 1, res->nspawns, res->start_nsecs / res->nspawns, first);
+
+        /* With one transaction per worker, there are no steady-state
+         * transactions to compare the first one with. */
+        if (res->niters > res->nspawns) {
+            unsigned long long steady =
+                (res->latency.sum - res->first_nsecs) /
+                (res->niters - res->nspawns);
+            printf(" steady_tx=%llu init_overhead=%lld", steady,
+                   (long long)first - (long long)steady);
+        } else {
+            printf(" steady_tx=n/a init_overhead=n/a");
+        }
+
+        printf(" release=%llu teardown=%llu\n",
+               res->release_nsecs / res->nspawns,
+               res->teardown_nsecs / res->nspawns);
+    }
+}
+
+/* Writes the threads' transaction events in Chrome's trace-event
+ * format, which can be loaded into chrome://tracing or Perfetto. */
+static int
+write_trace(const char* filename, const struct thread* beg,
+            const struct thread* end)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "fopen(%s) failed: %s\n", filename, strerror(errno));
+        return -1;
+    }
+
+    unsigned long long base_nsecs = 0;
+    for (const struct thread* pos = beg; pos < end; ++pos) {
+        unsigned long long nsecs = trace_ring_first_nsecs(&pos->res_trace);
+        if (nsecs && (!base_nsecs || nsecs < base_nsecs)) {
+            base_nsecs = nsecs;
+        }
+    }
+
+    trace_write_begin(file);
+    for (const struct thread* pos = beg; pos < end; ++pos) {
+        trace_write_thread(file, &pos->res_trace, pos - beg + 1,
+                           pos->group->test->name, base_nsecs);
+    }
+    trace_write_end(file);
+
+    if (fclose(file) == EOF) {
+        fprintf(stderr, "fclose(%s) failed: %s\n", filename, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Prints the time spent in execution, commit and abort phases as
+ * percentiles, and as shares of the total transaction time. */
+static void
+print_breakdown(const char* name, unsigned long id,
+                const struct histogram* exec,
+                const struct histogram* commit,
+                const struct histogram* abort)
+{
+    double total = exec->sum + commit->sum + abort->sum;
+    if (!total) {
+        total = 1;
+    }
+
+    printf("# breakdown %s=%lu"
+           " exec_p50=%llu exec_p99=%llu exec_share=%.3f"
+           " commit_p50=%llu commit_p99=%llu commit_share=%.3f"
+           " aborted=%llu abort_p50=%llu abort_p99=%llu abort_share=%.3f\n",
+           name, id,
+           histogram_percentile(exec, 50),
+           histogram_percentile(exec, 99),
+           exec->sum / total,
+           histogram_percentile(commit, 50),
+           histogram_percentile(commit, 99),
+           commit->sum / total,
+           abort->count,
+           histogram_percentile(abort, 50),
+           histogram_percentile(abort, 99),
+           abort->sum / total);
+}
+
+static void
+print_thread_breakdown(const struct thread* beg, const struct thread* end)
+{
+    for (const struct thread* pos = beg; pos < end; ++pos) {
+        print_breakdown("thread", pos - beg + 1, &pos->res_stats.exec,
+                        &pos->res_stats.commit, &pos->res_stats.abort);
+    }
+}
+
+static void
+print_group_breakdown(size_t ngroups, const struct test_result* result)
+{
+    for (size_t i = 0; i < ngroups; ++i) {
+        print_breakdown("group", i + 1, &result[i].exec, &result[i].commit,
+                        &result[i].abort);
+    }
+}
+
+/* Returns true if one of the previous groups' tests shares the
+ * group's init function. Tests can share their setup, such as the
+ * file I/O tests, which must only be initialized once. */
+static int
+is_init_in_previous_group(const struct test_group* group, size_t i)
+{
+    for (size_t j = 0; j < i; ++j) {
+        if (group[j].test->init == group[i].test->init) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Returns true if one of the previous groups' tests shares the
+ * group's uninit function. */
+static int
+is_uninit_in_previous_group(const struct test_group* group, size_t i)
+{
+    for (size_t j = 0; j < i; ++j) {
+        if (group[j].test->uninit == group[i].test->uninit) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void
+uninit_tests(const struct test_group* group, size_t ngroups)
+{
+    for (size_t i = 0; i < ngroups; ++i) {
+        if (!group[i].test->uninit || is_uninit_in_previous_group(group, i)) {
+            continue;
+        }
+        group[i].test->uninit();
+    }
+}
+
+static int
+init_tests(const struct test_group* group, size_t ngroups,
+           unsigned long nthreads, const struct test_params* params)
+{
+    for (size_t i = 0; i < ngroups; ++i) {
+        if (!group[i].test->init || is_init_in_previous_group(group, i)) {
+            continue;
+        }
+        int res = group[i].test->init(nthreads, params);
+        if (res < 0) {
+            uninit_tests(group, i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
 int
-run_test(unsigned long nthreads, unsigned long nmsecs,
-         const struct test_func* test, unsigned long nloads,
-         unsigned long nstores)
+run_test(const struct test_group* group, size_t ngroups,
+         const struct test_params* params, struct test_result* result)
 {
+    unsigned long nthreads = 0;
+    for (size_t i = 0; i < ngroups; ++i) {
+        nthreads += group[i].nthreads;
+    }
+
+    int res = init_tests(group, ngroups, nthreads, params);
+    if (res < 0) {
+        return -1;
+    }
+
     pthread_barrier_t wait;
     int err = pthread_barrier_init(&wait, NULL, nthreads);
     if (err) {
         fprintf(stderr, "pthread_barrier_init() failed: %s\n", strerror(err));
-        return -1;
+        goto err_pthread_barrier_init;
     }
 
-    struct thread* th = new_threads(&wait, nthreads, nmsecs, test->call,
-                                    nloads, nstores);
+    size_t trace_nevents = params->trace_file ? params->trace_nevents : 0;
+
+    struct thread* th = new_threads(&wait, nthreads, params->nmsecs,
+                                    params->churn, params->phases,
+                                    trace_nevents, group, ngroups);
     if (!th) {
         goto err_new_threads;
     }
 
-    int res = run_threads(th, th + nthreads);
+    struct mem_sampler sampler;
+    res = mem_sampler_start(&sampler, params->mem_interval);
+    if (res < 0) {
+        goto err_mem_sampler_start;
+    }
+
+    res = run_threads(th, th + nthreads);
     if (res < 0) {
         goto err_run_threads;
     }
@@ -299,24 +884,71 @@ run_test(unsigned long nthreads, unsigned long nmsecs,
         goto err_join_threads;
     }
 
+    res = mem_sampler_stop(&sampler);
+    if (res < 0) {
+        goto err_mem_sampler_stop;
+    }
+
     print_results(th, th + nthreads);
+    collect_group_results(th, th + nthreads, group, ngroups, result);
+    print_group_results(group, ngroups, result, params);
+    if (params->breakdown) {
+        print_thread_breakdown(th, th + nthreads);
+        print_group_breakdown(ngroups, result);
+    }
+    print_io_results(group, ngroups, result, params);
+    if (params->model) {
+        res = print_model_results(group, ngroups, result, params);
+        if (res < 0) {
+            goto err_print_model_results;
+        }
+    }
+    if (params->churn) {
+        print_churn_results(ngroups, result);
+    }
+    print_mem_samples(&sampler);
+    if (malloc_count_is_enabled()) {
+        print_malloc_results(ngroups, result);
+    }
+
+    if (params->trace_file) {
+        res = write_trace(params->trace_file, th, th + nthreads);
+        if (res < 0) {
+            goto err_write_trace;
+        }
+    }
 
+    mem_sampler_uninit(&sampler);
     delete_threads(th, nthreads);
 
     err = pthread_barrier_destroy(&wait);
     if (err) {
         fprintf(stderr, "pthread_barrier_destroy() failed: %s\n",
                 strerror(err));
-        return -1;
+        goto err_pthread_barrier_destroy;
     }
 
+    uninit_tests(group, ngroups);
+
     return 0;
 
 err_join_threads:
     /* fall through */
 err_run_threads:
+    mem_sampler_stop(&sampler);
+err_write_trace:
+    /* fall through */
+err_print_model_results:
+    /* fall through */
+err_mem_sampler_stop:
+    mem_sampler_uninit(&sampler);
+err_mem_sampler_start:
     delete_threads(th, nthreads);
 err_new_threads:
     pthread_barrier_destroy(&wait);
+err_pthread_barrier_destroy:
+    /* fall through */
+err_pthread_barrier_init:
+    uninit_tests(group, ngroups);
     return -1;
 }
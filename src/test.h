@@ -20,16 +20,115 @@
 
 #pragma once
 
+#include <stddef.h>
+#include "histogram.h"
+#include "malloccnt.h"
+
+struct tx_stats;
+
 typedef void (*call_func)(unsigned long tid,
                           unsigned long nloads,
-                          unsigned long nstores);
+                          unsigned long nstores,
+                          unsigned long ncompute,
+                          struct tx_stats* stats);
+
+struct test_params;
+
+/**
+ * Describes how a test accesses its data, for the conflict model.
+ */
+enum access_pattern {
+    ACCESS_PRIVATE,     /* no data shared among threads */
+    ACCESS_UNIFORM,     /* uniformly distributed random accesses */
+    ACCESS_SEQUENTIAL   /* contiguous accesses from a random offset */
+};
 
+struct access_model {
+    enum access_pattern pattern;
+    const void* region; /* shared data; tests on the same data conflict */
+    double footprint;   /* size of shared data in bytes */
+    double access_size; /* bytes per access */
+    double align;       /* alignment, or distance of sequential accesses */
+};
+
+typedef int  (*init_func)(unsigned long nthreads,
+                          const struct test_params* params);
+typedef void (*uninit_func)(void);
+typedef void (*model_func)(struct access_model* model,
+                           const struct test_params* params);
+
+/**
+ * A test. The optional init and uninit functions set up and tear
+ * down resources shared by all threads of a run. If block_io is set,
+ * each load or store transfers params->block_size bytes. The model
+ * function describes the test's accesses.
+ */
 struct test_func {
     const char* name;
     call_func   call;
+    init_func   init;
+    uninit_func uninit;
+    int         block_io;
+    model_func  model;
+};
+
+/**
+ * A group of threads that run the same test with the same parameters.
+ */
+struct test_group {
+    const struct test_func* test;
+    unsigned long nthreads;
+    unsigned long nloads;
+    unsigned long nstores;
+    unsigned long ncompute; /* nsecs of computation per transaction */
+    unsigned long nthink;   /* nsecs of think time between transactions */
+};
+
+/**
+ * The accumulated results of a group of threads.
+ */
+struct test_result {
+    double ncommits;    /* commits per second */
+    double nrestarts;   /* restarts per second */
+
+    unsigned long long niters;
+
+    struct histogram latency;
+    struct histogram exec;
+    struct histogram commit;
+    struct histogram abort;
+
+    struct malloc_count malloc;
+
+    /* thread churn; sums over all workers in nanoseconds */
+    unsigned long long nspawns;
+    unsigned long long start_nsecs;
+    unsigned long long first_nsecs;
+    unsigned long long release_nsecs;
+    unsigned long long teardown_nsecs;
+};
+
+/**
+ * Parameters that apply to all groups of a test run.
+ */
+struct test_params {
+    unsigned long nmsecs;   /* duration of the test */
+    int breakdown;          /* print per-thread phase breakdown */
+    int phases;             /* record execution, commit and abort times */
+    unsigned long mem_interval; /* msecs between memory samples, or 0 */
+    unsigned long churn;    /* transactions per short-lived thread, or 0 */
+    size_t block_size;      /* bytes per access of block-I/O tests */
+    const char* dir;        /* directory for test files */
+    int model;              /* print predicted conflict rates */
+    size_t granularity;     /* bytes per lock in the conflict model */
+    const char* trace_file; /* output file for event traces, or NULL */
+    size_t trace_nevents;   /* capacity of each thread's trace ring */
 };
 
+/**
+ * Runs the test groups concurrently and stores each group's results
+ * in the respective element of the result array.
+ */
 int
-run_test(unsigned long nthreads, unsigned long nmsecs,
-         const struct test_func* test, unsigned long nloads,
-         unsigned long nstores);
+run_test(const struct test_group* group, size_t ngroups,
+         const struct test_params* params, struct test_result* result);
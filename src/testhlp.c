@@ -19,10 +19,12 @@
  */
 
 #include "testhlp.h"
+#include <errno.h>
 #include <picotm/picotm.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 void
 abort_transaction_on_error(const char* origin)
@@ -53,3 +55,18 @@ abort_transaction_on_error(const char* origin)
 
     abort();
 }
+
+/* Returns the number of nanoseconds on the monotonic clock */
+long long
+getnsecs(void)
+{
+    struct timespec t;
+    int res = clock_gettime(CLOCK_MONOTONIC, &t);
+    if (res < 0) {
+        fprintf(stderr, "clock_gettime() failed: %s\n",
+                strerror(errno));
+        return -1;
+    }
+
+    return t.tv_sec * 1000000000ll + t.tv_nsec;
+}
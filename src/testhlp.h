@@ -22,3 +22,10 @@
 
 void
 abort_transaction_on_error(const char* origin);
+
+/**
+ * Returns the number of nanoseconds on the monotonic clock, or -1 on
+ * errors.
+ */
+long long
+getnsecs(void);
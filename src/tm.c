@@ -19,19 +19,30 @@
  */
 
 #include "tm.h"
+#include <string.h>
 #include <picotm/picotm.h>
 #include <picotm/picotm-tm-ctypes.h>
 #include <picotm/stdlib-tm.h>
+#include "io.h"
 #include "ptr.h"
+#include "spin.h"
 #include "testhlp.h"
+#include "txstats.h"
 
 uint8_t mem_buf[1024];
 
+/* A footprint that is large enough to hold the read and write sets of
+ * long-running transactions. Pages are only faulted in on access. */
+unsigned long mem_large_buf[(64ul << 20) / sizeof(unsigned long)];
+
 void
-tm_test_random_rw(unsigned long tid, unsigned long nloads, unsigned long nstores)
+tm_test_random_rw(unsigned long tid, unsigned long nloads, unsigned long nstores,
+                  unsigned long ncompute, struct tx_stats* stats)
 {
     picotm_begin
 
+        tx_stats_begin_attempt(stats);
+
         unsigned int seed = tid;
 
         for (unsigned long i = 0; i < nloads; ++i) {
@@ -43,6 +54,8 @@ tm_test_random_rw(unsigned long tid, unsigned long nloads, unsigned long nstores
             load_ulong_tx((void*)(mem_buf + off));
         }
 
+        spin_nsecs(ncompute);
+
         for (unsigned long i = 0; i < nstores; ++i) {
 
             int rngval = rand_r_tm(&seed);
@@ -52,21 +65,28 @@ tm_test_random_rw(unsigned long tid, unsigned long nloads, unsigned long nstores
             store_ulong_tx((void*)(mem_buf + off), tid);
         }
 
+        tx_stats_end_exec(stats);
+
     picotm_commit
 
         abort_transaction_on_error(__func__);
 
     picotm_end
+
+    tx_stats_end_commit(stats);
 }
 
 void
-tm_test_seq_rw(unsigned long tid, unsigned long nloads, unsigned long nstores)
+tm_test_seq_rw(unsigned long tid, unsigned long nloads, unsigned long nstores,
+               unsigned long ncompute, struct tx_stats* stats)
 {
     unsigned int seed = tid;
     int rngval = rand_r(&seed);
 
     picotm_begin
 
+        tx_stats_begin_attempt(stats);
+
         unsigned long off = rngval;
 
         for (unsigned long i = 0; i < nloads; ++i, ++off) {
@@ -76,6 +96,8 @@ tm_test_seq_rw(unsigned long tid, unsigned long nloads, unsigned long nstores)
             load_ulong_tx((void*)(mem_buf + off));
         }
 
+        spin_nsecs(ncompute);
+
         for (unsigned long i = 0; i < nstores; ++i, ++off) {
 
             off %= sizeof(mem_buf);
@@ -83,21 +105,137 @@ tm_test_seq_rw(unsigned long tid, unsigned long nloads, unsigned long nstores)
             store_ulong_tx((void*)(mem_buf + off), tid);
         }
 
+        tx_stats_end_exec(stats);
+
     picotm_commit
 
         abort_transaction_on_error(__func__);
 
     picotm_end
+
+    tx_stats_end_commit(stats);
+}
+
+void
+tm_test_large_prefault(void)
+{
+    memset(mem_large_buf, 0, sizeof(mem_large_buf));
+}
+
+void
+tm_test_large_rw(unsigned long tid, unsigned long nloads,
+                 unsigned long nstores, unsigned long ncompute,
+                 struct tx_stats* stats)
+{
+    picotm_begin
+
+        tx_stats_begin_attempt(stats);
+
+        unsigned int seed = tid;
+
+        for (unsigned long i = 0; i < nloads; ++i) {
+
+            int rngval = rand_r_tm(&seed);
+
+            unsigned long off = rngval % arraylen(mem_large_buf);
+
+            load_ulong_tx(mem_large_buf + off);
+        }
+
+        spin_nsecs(ncompute);
+
+        for (unsigned long i = 0; i < nstores; ++i) {
+
+            int rngval = rand_r_tm(&seed);
+
+            unsigned long off = rngval % arraylen(mem_large_buf);
+
+            store_ulong_tx(mem_large_buf + off, tid);
+        }
+
+        tx_stats_end_exec(stats);
+
+    picotm_commit
+
+        abort_transaction_on_error(__func__);
+
+    picotm_end
+
+    tx_stats_end_commit(stats);
+}
+
+static void
+tm_model_random_rw(struct access_model* model,
+                   const struct test_params* params)
+{
+    model->pattern = ACCESS_UNIFORM;
+    model->region = mem_buf;
+    model->footprint = sizeof(mem_buf);
+    model->access_size = sizeof(unsigned long);
+    model->align = 1;
+}
+
+static void
+tm_model_seq_rw(struct access_model* model, const struct test_params* params)
+{
+    model->pattern = ACCESS_SEQUENTIAL;
+    model->region = mem_buf;
+    model->footprint = sizeof(mem_buf);
+    model->access_size = sizeof(unsigned long);
+    model->align = 1;
+}
+
+static void
+tm_model_large_rw(struct access_model* model,
+                  const struct test_params* params)
+{
+    model->pattern = ACCESS_UNIFORM;
+    model->region = mem_large_buf;
+    model->footprint = sizeof(mem_large_buf);
+    model->access_size = sizeof(mem_large_buf[0]);
+    model->align = sizeof(mem_large_buf[0]);
 }
 
 struct test_func tm_test[] = {
     {
         "random_rw",
-        tm_test_random_rw
+        tm_test_random_rw,
+        NULL,
+        NULL,
+        0,
+        tm_model_random_rw
     },
     {
         "seq_rw",
-        tm_test_seq_rw
+        tm_test_seq_rw,
+        NULL,
+        NULL,
+        0,
+        tm_model_seq_rw
+    },
+    {
+        "large_rw",
+        tm_test_large_rw,
+        NULL,
+        NULL,
+        0,
+        tm_model_large_rw
+    },
+    {
+        "file_rw",
+        io_test_private_rw,
+        io_test_init,
+        io_test_uninit,
+        1,
+        io_model_private_rw
+    },
+    {
+        "shared_file_rw",
+        io_test_shared_rw,
+        io_test_init,
+        io_test_uninit,
+        1,
+        io_model_shared_rw
     }
 };
 
@@ -27,3 +27,10 @@ extern struct test_func tm_test[];
 
 size_t
 number_of_tm_tests(void);
+
+/**
+ * Faults in the buffer of the large workload, so that it does not
+ * show up as memory growth during a test.
+ */
+void
+tm_test_large_prefault(void);
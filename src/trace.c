@@ -0,0 +1,178 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "trace.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int
+trace_ring_init(struct trace_ring* self, size_t nevents)
+{
+    assert(self);
+
+    self->event = NULL;
+    self->mask = 0;
+    self->head = 0;
+
+    if (!nevents) {
+        return 0;
+    }
+
+    if (nevents > SIZE_MAX / 2 / sizeof(*self->event)) {
+        fprintf(stderr, "too many trace events\n");
+        return -1;
+    }
+
+    size_t size = 1;
+    while (size < nevents) {
+        size <<= 1;
+    }
+
+    self->event = malloc(size * sizeof(*self->event));
+    if (!self->event) {
+        fprintf(stderr, "malloc() failed: %s\n", strerror(errno));
+        return -1;
+    }
+    self->mask = size - 1;
+
+    return 0;
+}
+
+void
+trace_ring_uninit(struct trace_ring* self)
+{
+    assert(self);
+
+    free(self->event);
+}
+
+void
+trace_ring_record(struct trace_ring* self, enum trace_event_type type,
+                  unsigned long long nsecs)
+{
+    if (!self->event) {
+        return;
+    }
+
+    struct trace_event* event = self->event + (self->head & self->mask);
+    event->nsecs = nsecs;
+    event->type = type;
+
+    ++self->head;
+}
+
+static unsigned long long
+first_index(const struct trace_ring* self)
+{
+    size_t size = self->mask + 1;
+
+    return self->head > size ? self->head - size : 0;
+}
+
+unsigned long long
+trace_ring_first_nsecs(const struct trace_ring* self)
+{
+    assert(self);
+
+    if (!self->event || !self->head) {
+        return 0;
+    }
+    return self->event[first_index(self) & self->mask].nsecs;
+}
+
+void
+trace_write_begin(FILE* file)
+{
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                  "\"tid\":0,\"args\":{\"name\":\"picotm-perf\"}}");
+}
+
+static void
+write_complete_event(FILE* file, const char* name, unsigned long tid,
+                     unsigned long long beg, unsigned long long end,
+                     unsigned long long base_nsecs)
+{
+    fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,"
+                  "\"ts\":%.3f,\"dur\":%.3f}",
+            name, tid, (beg - base_nsecs) / 1000.0, (end - beg) / 1000.0);
+}
+
+void
+trace_write_thread(FILE* file, const struct trace_ring* ring,
+                   unsigned long tid, const char* name,
+                   unsigned long long base_nsecs)
+{
+    assert(ring);
+
+    fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                  "\"tid\":%lu,\"args\":{\"name\":\"thread %lu (%s)\"}}",
+            tid, tid, name);
+
+    if (!ring->event) {
+        return;
+    }
+
+    int in_tx = 0;
+    unsigned long long attempt_begin = 0;
+
+    for (unsigned long long i = first_index(ring); i < ring->head; ++i) {
+
+        const struct trace_event* event = ring->event + (i & ring->mask);
+
+        switch (event->type) {
+            case TRACE_BEGIN:
+                in_tx = 1;
+                break;
+            case TRACE_RESTART:
+                if (in_tx) {
+                    write_complete_event(file, "aborted", tid, attempt_begin,
+                                         event->nsecs, base_nsecs);
+                    fprintf(file, ",\n{\"name\":\"restart\",\"ph\":\"i\","
+                                  "\"s\":\"t\",\"pid\":1,\"tid\":%lu,"
+                                  "\"ts\":%.3f}",
+                            tid, (event->nsecs - base_nsecs) / 1000.0);
+                }
+                /* The oldest events may have been overwritten, so we
+                 * might see a restart without its begin. */
+                in_tx = 1;
+                break;
+            case TRACE_COMMIT:
+                if (in_tx) {
+                    write_complete_event(file, name, tid, attempt_begin,
+                                         event->nsecs, base_nsecs);
+                }
+                in_tx = 0;
+                break;
+        }
+
+        attempt_begin = event->nsecs;
+    }
+}
+
+void
+trace_write_end(FILE* file)
+{
+    fprintf(file, "\n]}\n");
+}
@@ -0,0 +1,88 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+enum trace_event_type {
+    TRACE_BEGIN,    /* a transaction starts */
+    TRACE_RESTART,  /* the running attempt aborted, the next one starts */
+    TRACE_COMMIT    /* the transaction committed */
+};
+
+struct trace_event {
+    unsigned long long    nsecs;
+    enum trace_event_type type;
+};
+
+/**
+ * A per-thread ring buffer of transaction events. Only the owning
+ * thread records events, so no synchronization is required; the
+ * buffer is read after the thread has been joined. When full, the
+ * oldest events are overwritten.
+ */
+struct trace_ring {
+    struct trace_event* event;
+    size_t              mask;
+    unsigned long long  head;
+};
+
+/**
+ * Allocates room for at least nevents events. With nevents being 0,
+ * tracing is disabled and recording does nothing.
+ */
+int
+trace_ring_init(struct trace_ring* self, size_t nevents);
+
+void
+trace_ring_uninit(struct trace_ring* self);
+
+void
+trace_ring_record(struct trace_ring* self, enum trace_event_type type,
+                  unsigned long long nsecs);
+
+/**
+ * Returns the timestamp of the oldest recorded event, or 0 if there
+ * is none.
+ */
+unsigned long long
+trace_ring_first_nsecs(const struct trace_ring* self);
+
+/*
+ * Chrome trace-event output
+ */
+
+void
+trace_write_begin(FILE* file);
+
+/**
+ * Writes a thread's events. Attempts become complete events named
+ * after the test, or "aborted" for attempts that restarted. Times are
+ * relative to base_nsecs.
+ */
+void
+trace_write_thread(FILE* file, const struct trace_ring* ring,
+                   unsigned long tid, const char* name,
+                   unsigned long long base_nsecs);
+
+void
+trace_write_end(FILE* file);
@@ -0,0 +1,104 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "txstats.h"
+#include <assert.h>
+#include "testhlp.h"
+#include "trace.h"
+
+void
+tx_stats_init(struct tx_stats* self)
+{
+    assert(self);
+
+    self->enabled = 0;
+    histogram_init(&self->exec);
+    histogram_init(&self->commit);
+    histogram_init(&self->abort);
+    self->in_tx = 0;
+    self->attempt_begin = 0;
+    self->exec_end = 0;
+    self->abort_nsecs = 0;
+    self->trace = NULL;
+}
+
+void
+tx_stats_begin_attempt(struct tx_stats* self)
+{
+    assert(self);
+
+    if (!self->enabled) {
+        return;
+    }
+
+    unsigned long long now = getnsecs();
+
+    if (self->in_tx) {
+        /* the previous attempt has been aborted */
+        self->abort_nsecs += now - self->attempt_begin;
+        if (self->trace) {
+            trace_ring_record(self->trace, TRACE_RESTART, now);
+        }
+    } else {
+        self->in_tx = 1;
+        self->abort_nsecs = 0;
+        if (self->trace) {
+            trace_ring_record(self->trace, TRACE_BEGIN, now);
+        }
+    }
+
+    self->attempt_begin = now;
+}
+
+void
+tx_stats_end_exec(struct tx_stats* self)
+{
+    assert(self);
+
+    if (!self->enabled) {
+        return;
+    }
+
+    self->exec_end = getnsecs();
+}
+
+void
+tx_stats_end_commit(struct tx_stats* self)
+{
+    assert(self);
+
+    if (!self->enabled) {
+        return;
+    }
+
+    unsigned long long commit_end = getnsecs();
+
+    histogram_add(&self->exec, self->exec_end - self->attempt_begin);
+    histogram_add(&self->commit, commit_end - self->exec_end);
+    if (self->abort_nsecs) {
+        histogram_add(&self->abort, self->abort_nsecs);
+    }
+
+    if (self->trace) {
+        trace_ring_record(self->trace, TRACE_COMMIT, commit_end);
+    }
+
+    self->in_tx = 0;
+}
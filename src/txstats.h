@@ -0,0 +1,85 @@
+/*
+ * picotm-perf - Picotm Performance Tests
+ * Copyright (c) 2018   Thomas Zimmermann <contact@tzimmermann.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "histogram.h"
+
+struct trace_ring;
+
+/**
+ * Timing of a thread's transactions, split into the phases of the
+ * transaction. Workloads call the tx_stats_*() functions at the phase
+ * boundaries. All times are in nanoseconds.
+ *
+ * The execution phase is the successful run of the transaction body,
+ * the commit phase lasts from the last access until picotm_end. The
+ * abort time of a transaction is the time spent in all of its failed
+ * attempts, including rollback; only transactions that restarted at
+ * least once are counted.
+ *
+ * Taking the timestamps costs several clock reads per transaction,
+ * which is noticeable for small transactions. Unless enabled is set,
+ * the tx_stats_*() functions return immediately and the histograms
+ * stay empty.
+ *
+ * If a trace ring is set, the begin, restart and commit of each
+ * transaction are recorded as events. Tracing requires enabled to be
+ * set.
+ */
+struct tx_stats {
+    int enabled;
+
+    /* accumulated results */
+    struct histogram exec;
+    struct histogram commit;
+    struct histogram abort;
+
+    /* state of the current transaction */
+    int in_tx;
+    unsigned long long attempt_begin;
+    unsigned long long exec_end;
+    unsigned long long abort_nsecs;
+
+    struct trace_ring* trace;
+};
+
+void
+tx_stats_init(struct tx_stats* self);
+
+/**
+ * Marks the beginning of the transaction body. Call this at the
+ * beginning of each execution of the body.
+ */
+void
+tx_stats_begin_attempt(struct tx_stats* self);
+
+/**
+ * Marks the end of the transaction body; the last access has been
+ * performed and picotm is about to commit.
+ */
+void
+tx_stats_end_exec(struct tx_stats* self);
+
+/**
+ * Marks the completion of the commit. Call this after picotm_end.
+ */
+void
+tx_stats_end_commit(struct tx_stats* self);